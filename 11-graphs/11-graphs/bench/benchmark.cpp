@@ -0,0 +1,478 @@
+/**
+ * File: benchmark.cpp
+ * -------------------
+ * Times each stage of the rank pipeline (loading the entities, building
+ * the graph, building the solver's CSR structure, one power iteration,
+ * picking the top pages) on the bundled datasets and on synthetic R-MAT,
+ * Barabasi-Albert, Erdos-Renyi and geometric graphs, and prints the
+ * results as JSON so runs can be compared over time.  The geometric graph
+ * also times a shortest-path search and a minimum spanning tree.
+ * Each stage runs a few times untimed to warm caches and the allocator,
+ * then is timed repeatedly; the report gives the median and spread, the
+ * edges handled per second and the peak resident set size.  With
+ * --counters on it also reads the CPU's performance counters around each
+ * timed run and reports instructions per cycle and last-level cache and
+ * branch misses per edge (or per title or page), where the machine lets
+ * it; the report says why when it does not.
+ * Before timing anything it checks that Kruskal and Boruvka agree on the
+ * cost of a minimum spanning forest of a directed graph, and that a
+ * BlockRank run leaves a checkpoint the global solve resumes from, and
+ * stops if not.
+ *
+ * Usage: benchmark [--root DIR] [--repeats N] [--warmup N] [--threads N]
+ *                  [--synthetic-vertices N] [--only NAME] [--out FILE]
+ *                  [--counters on|off]
+ * where DIR holds Python/ and DATA/ (the repository root by default).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include "block-rank.h"
+#include "compact-graph.h"
+#include "graph-generators.h"
+#include "hardware-counters.h"
+#include "parallel.h"
+#include "rank-checkpoint.h"
+#include "rank-engine.h"
+#include "shortest-paths.h"
+#include "spanning-trees.h"
+#include "wiki-dataset.h"
+using namespace std;
+
+// power iterations timed together in each repeat of the iteration stage
+static const int kTimedIterations = 10;
+
+// the top-k stage picks this many pages, as getRank prints by default
+static const int kTopPages = 100;
+
+// the synthetic graphs' average out-degree
+static const int kSyntheticDegree = 16;
+
+struct Settings {
+    string root = ".";
+    int repeats = 7;
+    int warmup = 1;
+    int numThreads = 0;
+    int syntheticVertices = 200000;
+    string only;
+    string out;
+    bool useCounters = false;
+    // opened by main if useCounters
+    HardwareCounters *counters = nullptr;
+};
+
+// the timings of one stage; work is how many units (edges, titles, pages) one run handles
+struct Stage {
+    string name;
+    vector<double> seconds;
+    double work;
+    string unit;
+    // summed over the timed runs, when counters are on
+    bool counted = false;
+    HardwareCounts counts;
+    int countedRuns = 0;
+};
+
+struct DatasetReport {
+    string name;
+    int vertices = 0;
+    size_t edges = 0;
+    vector<Stage> stages;
+    string failure;
+    long peakRssKb = 0;
+};
+
+static long peakRssKb() {
+#ifdef _WIN32
+    return 0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#endif
+}
+
+// runs body settings.warmup times untimed, then settings.repeats times timed;
+// perRun divides each time (for stages that repeat their work inside body)
+static Stage measure(const Settings& settings, const string& name, double work, const string& unit,
+                     const function<void()>& body, int perRun = 1) {
+    Stage stage;
+    stage.name = name;
+    stage.work = work;
+    stage.unit = unit;
+    for (int i = 0; i < settings.warmup; i++) body();
+    HardwareCounts total;
+    total.cycles = total.instructions = total.cacheMisses = total.branchMisses = 0;
+    for (int i = 0; i < settings.repeats; i++) {
+        if (settings.counters != nullptr) settings.counters->start();
+        auto start = chrono::steady_clock::now();
+        body();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        if (settings.counters != nullptr) total += settings.counters->stop();
+        stage.seconds.push_back(elapsed.count() / perRun);
+    }
+    if (settings.counters != nullptr && settings.counters->available()) {
+        stage.counted = true;
+        stage.counts = total;
+        stage.countedRuns = settings.repeats * perRun;
+    }
+    sort(stage.seconds.begin(), stage.seconds.end());
+    return stage;
+}
+
+// the stages every graph goes through once it is built
+static void measureSolver(const Settings& settings, const CompactGraph& g, DatasetReport& report) {
+    report.vertices = g.numVertices();
+    report.edges = g.numEdges();
+    double m = g.numEdges();
+    report.stages.push_back(measure(settings, "csr-build", m, "edges", [&]() { RankEngine engine(g); }));
+
+    RankEngine engine(g);
+    RankOptions options;
+    options.tolerance = 0;
+    options.maxIterations = kTimedIterations;
+    options.numThreads = settings.numThreads;
+    vector<double> ranks;
+    report.stages.push_back(measure(settings, "iteration", m, "edges", [&]() { ranks = engine.solve(options).ranks; },
+                                    kTimedIterations));
+
+    vector<int> order(ranks.size());
+    int k = min(kTopPages, (int) ranks.size());
+    report.stages.push_back(measure(settings, "top-k", ranks.size(), "pages", [&]() {
+        for (int v = 0; v < (int) order.size(); v++) order[v] = v;
+        partial_sort(order.begin(), order.begin() + k, order.end(),
+                     [&ranks](int a, int b) { return ranks[a] > ranks[b]; });
+    }));
+}
+
+static DatasetReport wikipediaDataset(const Settings& settings, const string& name, const string& namesFile,
+                                      const string& linksFile) {
+    DatasetReport report;
+    report.name = name;
+    string names = settings.root + "/Python/" + namesFile;
+    string links = settings.root + "/Python/" + linksFile;
+    unordered_set<string> entities = loadEntities(names);
+    report.stages.push_back(measure(settings, "entity-load", entities.size(), "titles",
+                                    [&]() { loadEntities(names); }));
+    CompactGraph g = loadWikipediaGraph({links}, entities);
+    report.stages.push_back(measure(settings, "graph-build", g.numEdges(), "edges",
+                                    [&]() { loadWikipediaGraph({links}, entities); }));
+    measureSolver(settings, g, report);
+    return report;
+}
+
+static DatasetReport edgeListDataset(const Settings& settings, const string& name, const string& fileName) {
+    DatasetReport report;
+    report.name = name;
+    string path = settings.root + "/" + fileName;
+    CompactGraph g = loadEdgeList(path);
+    report.stages.push_back(measure(settings, "graph-build", g.numEdges(), "edges", [&]() { loadEdgeList(path); }));
+    measureSolver(settings, g, report);
+    return report;
+}
+
+// the synthetic graphs all come from a fixed seed, so every run sees the same ones
+static DatasetReport syntheticDataset(const Settings& settings, const string& name,
+                                      const function<CompactGraph(const GeneratorOptions&)>& generate) {
+    DatasetReport report;
+    report.name = name;
+    GeneratorOptions options;
+    options.numThreads = settings.numThreads;
+    CompactGraph g = generate(options);
+    report.stages.push_back(measure(settings, "generate", g.numEdges(), "edges", [&]() { generate(options); }));
+    measureSolver(settings, g, report);
+    return report;
+}
+
+// a geometric graph, which is also timed under Dijkstra and Kruskal
+static DatasetReport geometricDataset(const Settings& settings, const string& name, int n) {
+    DatasetReport report;
+    report.name = name;
+    GeometricOptions geometry;
+    geometry.range = geometricRange(max(2, n), kSyntheticDegree);
+    GeneratorOptions options;
+    options.numThreads = settings.numThreads;
+    CompactGraph g = geometricGraph(n, geometry, options);
+    double m = g.numEdges();
+    report.stages.push_back(measure(settings, "generate", m, "edges", [&]() { geometricGraph(n, geometry, options); }));
+    if (n > 0) {
+        report.stages.push_back(measure(settings, "shortest-paths", m, "edges",
+                                        [&]() { computeShortestPaths(g, 0); }));
+    }
+    report.stages.push_back(measure(settings, "spanning-tree", m, "edges",
+                                    [&]() { kruskalForest(g, settings.numThreads); }));
+    measureSolver(settings, g, report);
+    return report;
+}
+
+// Kruskal and Boruvka must find forests of the same cost, following links
+// either way; a directed graph with varied costs catches a Boruvka that only
+// looks along out-links (on the triangle 0->1 (3), 1->2 (1), 2->0 (2), for one)
+static string checkSpanningForests() {
+    vector<CompactGraph> graphs = {buildCompactGraph(3, {{0, 1, 3}, {1, 2, 1}, {2, 0, 2}})};
+    GeneratorOptions options;
+    options.seed = 7;
+    CompactGraph random = erdosRenyiGraph(5000, 4.0 / 5000, options);
+    for (size_t e = 0; e < random.costs.size(); e++) random.costs[e] = 1 + (e * 2654435761ULL >> 7) % 1000;
+    graphs.push_back(random);
+    for (const CompactGraph& g : graphs) {
+        double kruskal = kruskalForest(g).totalCost, boruvka = boruvkaForest(g).totalCost;
+        if (kruskal != boruvka) {
+            return "spanning forests disagree on a " + to_string(g.numVertices()) + "-vertex graph: Kruskal "
+                   + to_string(kruskal) + ", Boruvka " + to_string(boruvka);
+        }
+    }
+    return "";
+}
+
+// BlockRank's checkpoint must hold the global vector, not one of the many
+// local and block-graph solves it runs along the way: a run stopped early
+// and started again (which redoes the estimate) has to carry on from it
+static string checkBlockRankCheckpoint() {
+    GeneratorOptions generator;
+    generator.seed = 11;
+    CompactGraph g = erdosRenyiGraph(4000, 8.0 / 4000, generator);
+    vector<int> block(g.numVertices());
+    for (int v = 0; v < g.numVertices(); v++) block[v] = v / 100;
+    RankEngine engine(g);
+    RankOptions cold;
+    RankResult expected = engine.solve(cold);
+
+    RankOptions options;
+    options.checkpointFile = "benchmark-blockrank.checkpoint";
+    options.maxIterations = 3;
+    remove(options.checkpointFile.c_str());
+    solveBlockRank(engine, g, block, options);
+    estimateBlockRank(g, block, options);
+    RankCheckpoint checkpoint;
+    bool saved = loadRankCheckpoint(options.checkpointFile, checkpoint);
+    options.maxIterations = cold.maxIterations;
+    RankResult resumed = engine.solve(options);
+    remove(options.checkpointFile.c_str());
+
+    if (!saved || (int) checkpoint.ranks.size() != g.numVertices() || checkpoint.iteration != 3) {
+        return "BlockRank's checkpoint does not hold the global solve";
+    }
+    double difference = 0;
+    for (int v = 0; v < g.numVertices(); v++) difference += fabs(resumed.ranks[v] - expected.ranks[v]);
+    if (difference > 1e-8 || resumed.iterations <= 3) {
+        return "resuming from BlockRank's checkpoint gave ranks " + to_string(difference) + " away from a cold solve";
+    }
+    return "";
+}
+
+// quotes text as a JSON string
+static string jsonString(const string& text) {
+    string quoted = "\"";
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\') {
+            quoted += '\\';
+            quoted += ch;
+        } else if ((unsigned char) ch < 0x20) {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", ch);
+            quoted += escape;
+        } else {
+            quoted += ch;
+        }
+    }
+    return quoted + "\"";
+}
+
+static string jsonNumber(double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.6g", value);
+    return buffer;
+}
+
+// the value below which the given fraction of the sorted samples fall
+static double percentile(const vector<double>& sorted, double fraction) {
+    if (sorted.empty()) return 0;
+    double position = fraction * (sorted.size() - 1);
+    size_t below = (size_t) position;
+    size_t above = min(below + 1, sorted.size() - 1);
+    return sorted[below] + (position - below) * (sorted[above] - sorted[below]);
+}
+
+static string stageJson(const Stage& stage) {
+    double median = percentile(stage.seconds, 0.5);
+    string json = "{\"stage\":" + jsonString(stage.name);
+    json += ",\"runs\":" + to_string(stage.seconds.size());
+    json += ",\"median_s\":" + jsonNumber(median);
+    json += ",\"p10_s\":" + jsonNumber(percentile(stage.seconds, 0.1));
+    json += ",\"p90_s\":" + jsonNumber(percentile(stage.seconds, 0.9));
+    json += ",\"min_s\":" + jsonNumber(stage.seconds.empty() ? 0 : stage.seconds.front());
+    json += ",\"max_s\":" + jsonNumber(stage.seconds.empty() ? 0 : stage.seconds.back());
+    json += ",\"" + stage.unit + "_per_s\":" + jsonNumber(median > 0 ? stage.work / median : 0);
+    if (stage.counted) {
+        // per run, like the work; a count the machine would not give is null
+        const HardwareCounts& counts = stage.counts;
+        auto perRun = [&stage](long long count) {
+            return count < 0 ? string("null") : jsonNumber((double) count / stage.countedRuns);
+        };
+        auto perUnit = [&stage](long long count) {
+            return count < 0 || stage.work <= 0 ? string("null")
+                                                 : jsonNumber((double) count / stage.countedRuns / stage.work);
+        };
+        string unit = stage.unit.substr(0, stage.unit.size() - 1);
+        json += ",\"cycles\":" + perRun(counts.cycles);
+        json += ",\"instructions\":" + perRun(counts.instructions);
+        json += ",\"ipc\":" + (counts.ipc() < 0 ? string("null") : jsonNumber(counts.ipc()));
+        json += ",\"llc_misses_per_" + unit + "\":" + perUnit(counts.cacheMisses);
+        json += ",\"branch_misses_per_" + unit + "\":" + perUnit(counts.branchMisses);
+    }
+    return json + "}";
+}
+
+static string reportJson(const Settings& settings, const vector<DatasetReport>& reports) {
+    string json = "{\"benchmark\":\"graphs\",\"threads\":" + to_string(resolveThreadCount(settings.numThreads));
+    json += ",\"repeats\":" + to_string(settings.repeats) + ",\"warmup\":" + to_string(settings.warmup);
+    if (settings.counters != nullptr) {
+        json += ",\"hardware_counters\":" + string(settings.counters->available() ? "true" : "false");
+        if (!settings.counters->problem().empty()) {
+            json += ",\"hardware_counters_problem\":" + jsonString(settings.counters->problem());
+        }
+    }
+    json += ",\"datasets\":[";
+    for (size_t i = 0; i < reports.size(); i++) {
+        const DatasetReport& report = reports[i];
+        if (i > 0) json += ",";
+        json += "\n{\"name\":" + jsonString(report.name);
+        if (!report.failure.empty()) {
+            json += ",\"error\":" + jsonString(report.failure) + "}";
+            continue;
+        }
+        json += ",\"vertices\":" + to_string(report.vertices) + ",\"edges\":" + to_string(report.edges);
+        json += ",\"peak_rss_kb\":" + to_string(report.peakRssKb) + ",\"stages\":[";
+        for (size_t s = 0; s < report.stages.size(); s++) {
+            if (s > 0) json += ",";
+            json += "\n  " + stageJson(report.stages[s]);
+        }
+        json += "]}";
+    }
+    return json + "],\n\"peak_rss_kb\":" + to_string(peakRssKb()) + "}\n";
+}
+
+static Settings parseSettings(int argc, char **argv) {
+    Settings settings;
+    for (int i = 1; i < argc; i++) {
+        string flag = argv[i];
+        if (i + 1 >= argc) {
+            fprintf(stderr, "benchmark: %s needs a value\n", flag.c_str());
+            exit(2);
+        }
+        string value = argv[++i];
+        if (flag == "--root") {
+            settings.root = value;
+        } else if (flag == "--repeats") {
+            settings.repeats = max(1, atoi(value.c_str()));
+        } else if (flag == "--warmup") {
+            settings.warmup = max(0, atoi(value.c_str()));
+        } else if (flag == "--threads") {
+            settings.numThreads = atoi(value.c_str());
+        } else if (flag == "--synthetic-vertices") {
+            settings.syntheticVertices = max(1, atoi(value.c_str()));
+        } else if (flag == "--only") {
+            settings.only = value;
+        } else if (flag == "--out") {
+            settings.out = value;
+        } else if (flag == "--counters") {
+            if (value != "on" && value != "off") {
+                fprintf(stderr, "benchmark: --counters takes on or off\n");
+                exit(2);
+            }
+            settings.useCounters = value == "on";
+        } else {
+            fprintf(stderr, "benchmark: unknown option %s\n", flag.c_str());
+            exit(2);
+        }
+    }
+    return settings;
+}
+
+int main(int argc, char **argv) {
+    Settings settings = parseSettings(argc, argv);
+    string failedCheck = checkSpanningForests();
+    if (failedCheck.empty()) failedCheck = checkBlockRankCheckpoint();
+    if (!failedCheck.empty()) {
+        fprintf(stderr, "benchmark: %s\n", failedCheck.c_str());
+        return 1;
+    }
+    unique_ptr<HardwareCounters> counters;
+    if (settings.useCounters) {
+        // opened before any worker threads start, so they are all counted
+        counters.reset(new HardwareCounters());
+        settings.counters = counters.get();
+        if (!counters->problem().empty()) fprintf(stderr, "benchmark: counters: %s\n", counters->problem().c_str());
+    }
+    int n = settings.syntheticVertices;
+    vector<pair<string, function<DatasetReport()>>> datasets = {
+        {"philosopher", [&]() { return wikipediaDataset(settings, "philosopher", "philosopher-names-v3.txt",
+                                                        "philosopher-links-v3.txt"); }},
+        {"programming-languages", [&]() { return wikipediaDataset(settings, "programming-languages",
+                                                                  "programming-languages-names.txt",
+                                                                  "programming-languages.txt"); }},
+        {"high-budget", [&]() { return wikipediaDataset(settings, "high-budget", "high-budget-names.txt",
+                                                        "high-budget.txt"); }},
+        {"cit-HepPh", [&]() { return edgeListDataset(settings, "cit-HepPh", "DATA/cit-HepPh.txt.gz"); }},
+        {"synthetic-rmat", [&]() {
+            int scale = 0;
+            while ((1 << scale) < n) scale++;
+            return syntheticDataset(settings, "synthetic-rmat", [&](const GeneratorOptions& options) {
+                return rmatGraph(scale, (long long) kSyntheticDegree << scale, RmatParameters(), options);
+            });
+        }},
+        {"synthetic-barabasi-albert", [&]() {
+            return syntheticDataset(settings, "synthetic-barabasi-albert", [&](const GeneratorOptions& options) {
+                return barabasiAlbertGraph(n, kSyntheticDegree, options);
+            });
+        }},
+        {"synthetic-erdos-renyi", [&]() {
+            return syntheticDataset(settings, "synthetic-erdos-renyi", [&](const GeneratorOptions& options) {
+                return erdosRenyiGraph(n, (double) kSyntheticDegree / max(1, n - 1), options);
+            });
+        }},
+        {"synthetic-geometric", [&]() { return geometricDataset(settings, "synthetic-geometric", n); }},
+    };
+
+    vector<DatasetReport> reports;
+    for (auto& dataset : datasets) {
+        if (!settings.only.empty() && settings.only != dataset.first) continue;
+        fprintf(stderr, "benchmarking %s\n", dataset.first.c_str());
+        try {
+            reports.push_back(dataset.second());
+        } catch (const exception& failure) {
+            // a missing dataset should not lose the others' numbers
+            DatasetReport report;
+            report.name = dataset.first;
+            report.failure = failure.what();
+            reports.push_back(report);
+        }
+        reports.back().peakRssKb = peakRssKb();
+    }
+
+    string json = reportJson(settings, reports);
+    if (settings.out.empty()) {
+        fputs(json.c_str(), stdout);
+    } else {
+        FILE *file = fopen(settings.out.c_str(), "w");
+        if (file == nullptr) {
+            fprintf(stderr, "benchmark: cannot write %s\n", settings.out.c_str());
+            return 1;
+        }
+        fputs(json.c_str(), file);
+        fclose(file);
+    }
+    return 0;
+}
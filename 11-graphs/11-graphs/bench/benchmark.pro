@@ -0,0 +1,14 @@
+# Standalone benchmark for the graph and rank code.  It links only the
+# engine library, which needs nothing beyond the standard library (and zlib
+# for the compressed datasets), so it does not link Qt or the Stanford
+# library and can run on a machine without a display.  Build it through
+# headless.pro, which builds the library first:
+#
+#     qmake headless.pro && make && ./bench/benchmark --root ../../.. --out bench.json
+
+TEMPLATE = app
+TARGET = benchmark
+
+include(../headless.pri)
+
+SOURCES += $$PWD/benchmark.cpp
@@ -0,0 +1,9 @@
+# The graphs-cli command-line tool (see graphs-cli.cpp); build it through
+# headless.pro so the engine library is built first.
+
+TEMPLATE = app
+TARGET = graphs-cli
+
+include(../headless.pri)
+
+SOURCES += $$PWD/graphs-cli.cpp
@@ -0,0 +1,272 @@
+/**
+ * File: graphs-cli.cpp
+ * --------------------
+ * A command-line front end to the engine, for running the rank pipeline
+ * on servers without the graphical console: it starts in milliseconds,
+ * needs no display, and writes its results with plain buffered stdio
+ * rather than through the console window.  Progress and timings go to
+ * stderr, so the results can be piped or redirected on their own.
+ *
+ * Usage: graphs-cli (--edges FILE | --names FILE --links FILE[,FILE...])
+ *                   [--exclude FILE] [--algorithm NAME] [--damping D]
+ *                   [--tolerance T] [--max-iterations N] [--threads N]
+ *                   [--samples N] [--min-component N] [--min-coreness K]
+ *                   [--top N] [--output FILE]
+ *
+ * --edges reads a SNAP edge list (gzip-compressed or not); --names and
+ * --links read a scraped Wikipedia dataset as buildEntities and
+ * addWikipediaLinks do, leaving out any titles listed in the --exclude
+ * file.  --min-component and --min-coreness prune the graph first, as
+ * wikipedaPR does.  The algorithms are
+ *
+ *   pagerank     PageRank, with damping (default 0.85) the chance that a
+ *                surfer follows a link rather than jumping anywhere,
+ *   betweenness  Brandes' betweenness, exact unless --samples is given,
+ *   coreness     each page's k-core number,
+ *   triangles    the triangles through each page, and
+ *   communities  Louvain communities, numbered from the largest.
+ *
+ * Each output line is "position<TAB>page<TAB>value", best first (or by
+ * community), for the top 100 pages unless --top says otherwise (0 lists
+ * them all).
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "betweenness.h"
+#include "communities.h"
+#include "compact-graph.h"
+#include "connected-components.h"
+#include "k-core.h"
+#include "rank-engine.h"
+#include "triangles.h"
+#include "wiki-dataset.h"
+using namespace std;
+
+// the output buffer; results are written in large blocks rather than per line
+static const size_t kOutputBuffer = 1 << 20;
+
+struct Settings {
+    string edges;
+    string names;
+    vector<string> links;
+    string exclude;
+    string algorithm = "pagerank";
+    double damping = 0.85;
+    double tolerance = 1e-10;
+    int maxIterations = 200;
+    int numThreads = 0;
+    int samples = 0;
+    int minComponent = 0;
+    int minCoreness = 0;
+    int top = 100;
+    string output;
+};
+
+// a score per page, and whether lower scores come first
+struct Scores {
+    vector<double> values;
+    bool ascending = false;
+};
+
+[[noreturn]] static void usage(const string& problem) {
+    fprintf(stderr, "graphs-cli: %s\n", problem.c_str());
+    fprintf(stderr, "usage: graphs-cli (--edges FILE | --names FILE --links FILE[,FILE...]) [--exclude FILE]\n"
+                    "                  [--algorithm pagerank|betweenness|coreness|triangles|communities]\n"
+                    "                  [--damping D] [--tolerance T] [--max-iterations N] [--threads N]\n"
+                    "                  [--samples N] [--min-component N] [--min-coreness K] [--top N]\n"
+                    "                  [--output FILE]\n");
+    exit(2);
+}
+
+static double parseNumber(const string& flag, const string& value) {
+    char *end;
+    double number = strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0') usage(flag + " needs a number, not " + value);
+    return number;
+}
+
+static int parseCount(const string& flag, const string& value) {
+    double number = parseNumber(flag, value);
+    if (number < 0 || number != (int) number) usage(flag + " needs a whole number of at least 0");
+    return (int) number;
+}
+
+static vector<string> splitCommas(const string& text) {
+    vector<string> parts;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        if (comma == string::npos) comma = text.size();
+        if (comma > start) parts.push_back(text.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return parts;
+}
+
+static Settings parseSettings(int argc, char **argv) {
+    Settings settings;
+    for (int i = 1; i < argc; i++) {
+        string flag = argv[i];
+        if (flag == "--help" || flag == "-h") usage("ranks the pages of a graph");
+        if (i + 1 >= argc) usage(flag + " needs a value");
+        string value = argv[++i];
+        if (flag == "--edges") {
+            settings.edges = value;
+        } else if (flag == "--names") {
+            settings.names = value;
+        } else if (flag == "--links") {
+            settings.links = splitCommas(value);
+        } else if (flag == "--exclude") {
+            settings.exclude = value;
+        } else if (flag == "--algorithm") {
+            settings.algorithm = value;
+        } else if (flag == "--damping") {
+            settings.damping = parseNumber(flag, value);
+        } else if (flag == "--tolerance") {
+            settings.tolerance = parseNumber(flag, value);
+        } else if (flag == "--max-iterations") {
+            settings.maxIterations = parseCount(flag, value);
+        } else if (flag == "--threads") {
+            settings.numThreads = parseCount(flag, value);
+        } else if (flag == "--samples") {
+            settings.samples = parseCount(flag, value);
+        } else if (flag == "--min-component") {
+            settings.minComponent = parseCount(flag, value);
+        } else if (flag == "--min-coreness") {
+            settings.minCoreness = parseCount(flag, value);
+        } else if (flag == "--top") {
+            settings.top = parseCount(flag, value);
+        } else if (flag == "--output") {
+            settings.output = value;
+        } else {
+            usage("unknown option " + flag);
+        }
+    }
+    if (settings.edges.empty() == (settings.names.empty() && settings.links.empty())) {
+        usage("give either --edges or --names and --links");
+    }
+    if (settings.edges.empty() && (settings.names.empty() || settings.links.empty())) {
+        usage("--names and --links go together");
+    }
+    if (!(settings.damping >= 0 && settings.damping < 1)) usage("--damping must be at least 0 and below 1");
+    const vector<string> algorithms = {"pagerank", "betweenness", "coreness", "triangles", "communities"};
+    if (find(algorithms.begin(), algorithms.end(), settings.algorithm) == algorithms.end()) {
+        usage("unknown algorithm " + settings.algorithm);
+    }
+    return settings;
+}
+
+// milliseconds since start, for the progress lines
+static double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static CompactGraph loadGraph(const Settings& settings) {
+    if (!settings.edges.empty()) return loadEdgeList(settings.edges);
+    unordered_set<string> entities = loadEntities(settings.names);
+    if (!settings.exclude.empty()) {
+        for (const string& title : loadEntities(settings.exclude)) entities.erase(title);
+    }
+    return loadWikipediaGraph(settings.links, entities);
+}
+
+static Scores runAlgorithm(const Settings& settings, const CompactGraph& g) {
+    Scores scores;
+    const string& algorithm = settings.algorithm;
+    if (algorithm == "pagerank") {
+        RankOptions options;
+        options.bias = 1 - settings.damping;
+        options.tolerance = settings.tolerance;
+        options.maxIterations = settings.maxIterations;
+        options.numThreads = settings.numThreads;
+        RankResult result = RankEngine(g).solve(options);
+        fprintf(stderr, "pagerank: %d iterations, residual %g\n", result.iterations, result.residual);
+        scores.values.swap(result.ranks);
+    } else if (algorithm == "betweenness") {
+        BetweennessOptions options;
+        options.numSamples = settings.samples;
+        options.numThreads = settings.numThreads;
+        BetweennessResult result = computeBetweenness(g, options);
+        fprintf(stderr, "betweenness: %d sources, error bound %g\n", result.sourcesUsed, result.errorBound);
+        scores.values.swap(result.scores);
+    } else if (algorithm == "coreness") {
+        CoreNumbers cores = parallelCoreDecomposition(g, settings.numThreads);
+        fprintf(stderr, "coreness: largest core %d\n", cores.maxCore);
+        scores.values.assign(cores.core.begin(), cores.core.end());
+    } else if (algorithm == "triangles") {
+        TriangleCounts counts = countTriangles(g, settings.numThreads);
+        fprintf(stderr, "triangles: %lld in all, average clustering %g\n", counts.total, counts.averageClustering);
+        scores.values.assign(counts.perVertex.begin(), counts.perVertex.end());
+    } else if (algorithm == "communities") {
+        CommunityOptions options;
+        options.numThreads = settings.numThreads;
+        Communities communities = detectCommunities(g, options);
+        fprintf(stderr, "communities: %d, modularity %g\n", communities.numCommunities, communities.modularity);
+        scores.values.assign(communities.community.begin(), communities.community.end());
+        scores.ascending = true;
+    } else {
+        usage("unknown algorithm " + algorithm);
+    }
+    return scores;
+}
+
+static void writeScores(const CompactGraph& g, const Scores& scores, int top, FILE *out) {
+    int n = scores.values.size();
+    int count = top == 0 ? n : min(top, n);
+    vector<int> order(n);
+    for (int v = 0; v < n; v++) order[v] = v;
+    // ties go to the lower vertex, so the listing is the same every run
+    auto better = [&scores](int a, int b) {
+        double x = scores.values[a], y = scores.values[b];
+        if (x != y) return scores.ascending ? x < y : x > y;
+        return a < b;
+    };
+    partial_sort(order.begin(), order.begin() + count, order.end(), better);
+    for (int i = 0; i < count; i++) {
+        int v = order[i];
+        fprintf(out, "%d\t%s\t%.10g\n", i + 1, g.names[v].c_str(), scores.values[v]);
+    }
+}
+
+int main(int argc, char **argv) {
+    Settings settings = parseSettings(argc, argv);
+    auto start = chrono::steady_clock::now();
+    try {
+        CompactGraph g = loadGraph(settings);
+        fprintf(stderr, "loaded %d pages and %zu links in %.1f ms\n", g.numVertices(), g.numEdges(),
+                elapsedMs(start));
+        if (settings.minComponent > 0) {
+            g = dropSmallComponents(g, findConnectedComponents(g, settings.numThreads), settings.minComponent);
+            fprintf(stderr, "kept %d pages in components of at least %d\n", g.numVertices(), settings.minComponent);
+        }
+        if (settings.minCoreness > 0) {
+            g = pruneToCore(g, parallelCoreDecomposition(g, settings.numThreads), settings.minCoreness);
+            fprintf(stderr, "kept %d pages and %zu links in the %d-core\n", g.numVertices(), g.numEdges(),
+                    settings.minCoreness);
+        }
+
+        auto solving = chrono::steady_clock::now();
+        Scores scores = runAlgorithm(settings, g);
+        fprintf(stderr, "%s took %.1f ms\n", settings.algorithm.c_str(), elapsedMs(solving));
+
+        FILE *out = settings.output.empty() ? stdout : fopen(settings.output.c_str(), "w");
+        if (out == nullptr) throw runtime_error("cannot write " + settings.output);
+        setvbuf(out, nullptr, _IOFBF, kOutputBuffer);
+        writeScores(g, scores, settings.top, out);
+        if (fflush(out) != 0 || (out != stdout && fclose(out) != 0)) {
+            throw runtime_error("could not finish writing the results");
+        }
+    } catch (const exception& failure) {
+        fprintf(stderr, "graphs-cli: %s\n", failure.what());
+        return 1;
+    }
+    fprintf(stderr, "done in %.1f ms\n", elapsedMs(start));
+    return 0;
+}
@@ -0,0 +1,37 @@
+# The engine library: every source in src/ that needs only the standard
+# library.  page-rank.cpp, graph-algorithms.cpp, graph-conversion.cpp and
+# graph-display.cpp work with the Stanford graph types and the graphics
+# window, so they stay in graphs.pro alone.
+
+TEMPLATE = lib
+TARGET = graphs-engine
+CONFIG += staticlib
+
+include(../headless.pri)
+
+SOURCES += \
+    $$PWD/../src/betweenness.cpp \
+    $$PWD/../src/block-rank.cpp \
+    $$PWD/../src/breadth-first-search.cpp \
+    $$PWD/../src/communities.cpp \
+    $$PWD/../src/compact-graph.cpp \
+    $$PWD/../src/connected-components.cpp \
+    $$PWD/../src/disjoint-set.cpp \
+    $$PWD/../src/fingerprint-index.cpp \
+    $$PWD/../src/graph-generators.cpp \
+    $$PWD/../src/hardware-counters.cpp \
+    $$PWD/../src/instrumentation.cpp \
+    $$PWD/../src/k-core.cpp \
+    $$PWD/../src/personalized-rank.cpp \
+    $$PWD/../src/pqueue-heap-pagerank.cpp \
+    $$PWD/../src/rank-checkpoint.cpp \
+    $$PWD/../src/rank-engine.cpp \
+    $$PWD/../src/rank-server.cpp \
+    $$PWD/../src/rank-snapshot.cpp \
+    $$PWD/../src/rank-store.cpp \
+    $$PWD/../src/shortest-paths.cpp \
+    $$PWD/../src/spanning-trees.cpp \
+    $$PWD/../src/strong-components.cpp \
+    $$PWD/../src/triangles.cpp \
+    $$PWD/../src/warm-start.cpp \
+    $$PWD/../src/wiki-dataset.cpp
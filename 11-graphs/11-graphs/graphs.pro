@@ -460,6 +460,10 @@ DEFINES += SPL_MERGED_LIBRARY_SINGLE_FILE
 # should we attempt to precompile the Qt moc_*.cpp files for speed?
 DEFINES += SPL_PRECOMPILE_QT_MOC_FILES
 
+# record timings and counters from the graph and rank code (see instrumentation.h)?
+# main then prints a summary and writes page-rank-trace.json for chrome://tracing
+# DEFINES += GRAPHS_INSTRUMENT
+
 # build-specific options (debug vs release)
 
 # make 'debug' target (default) use no optimization, generate debugger symbols,
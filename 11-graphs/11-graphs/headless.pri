@@ -0,0 +1,18 @@
+# Settings shared by the headless builds (see headless.pro).  They compile
+# the engine sources with the standard library alone: no Qt, no Stanford
+# library, and error() throwing std::runtime_error instead of opening the
+# graphical console (GRAPHS_HEADLESS, see engine-error.h).  zlib is used to
+# read the compressed datasets.
+
+CONFIG += console c++14 release warn_on
+CONFIG -= qt app_bundle
+
+DEFINES += GRAPHS_HEADLESS GRAPHS_ZLIB
+INCLUDEPATH += $$PWD/src
+
+# programs link the engine library built next to them
+!equals(TEMPLATE, lib) {
+    LIBS += -L$$OUT_PWD/../engine -lgraphs-engine -lz
+    unix: PRE_TARGETDEPS += $$OUT_PWD/../engine/libgraphs-engine.a
+    unix: LIBS += -lpthread
+}
@@ -0,0 +1,16 @@
+# Builds the graph and rank code without Qt or the Stanford library, for
+# servers with no display: the engine as a static library, the graphs-cli
+# command-line tool and the benchmark.  graphs.pro remains the build for
+# the graphical program.
+#
+#     qmake headless.pro && make
+#     ./cli/graphs-cli --edges ../../DATA/cit-HepPh.txt.gz --top 20
+
+TEMPLATE = subdirs
+SUBDIRS = engine cli bench
+
+engine.file = engine/engine.pro
+cli.file = cli/cli.pro
+cli.depends = engine
+bench.file = bench/benchmark.pro
+bench.depends = engine
@@ -0,0 +1,143 @@
+#include "betweenness.h"
+#include <cmath>
+#include <limits>
+#include <random>
+#include "parallel.h"
+#include "pqueue-heap-pagerank.h"
+using namespace std;
+
+// per-thread scratch space, sized once and reset only where a search touched it
+struct BrandesWorkspace {
+    vector<double> dist;
+    vector<double> sigma;
+    vector<double> delta;
+    vector<int> order; // vertices in the order they were settled
+    vector<double> scores;
+    HeapPQueuePR<int, double> pq;
+};
+
+static const double kUnreached = numeric_limits<double>::infinity();
+
+// hop-count search; fills order, dist and sigma (number of shortest paths)
+static void searchUnweighted(const CompactGraph& g, int source, BrandesWorkspace& w) {
+    w.dist[source] = 0;
+    w.sigma[source] = 1;
+    w.order.push_back(source);
+    for (size_t head = 0; head < w.order.size(); head++) {
+        int v = w.order[head];
+        for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            int u = g.targets[e];
+            if (w.dist[u] == kUnreached) {
+                w.dist[u] = w.dist[v] + 1;
+                w.order.push_back(u);
+            }
+            if (w.dist[u] == w.dist[v] + 1) w.sigma[u] += w.sigma[v];
+        }
+    }
+}
+
+// Dijkstra over arc costs; order holds vertices as they settle
+static void searchWeighted(const CompactGraph& g, int source, BrandesWorkspace& w) {
+    w.dist[source] = 0;
+    w.sigma[source] = 1;
+    w.pq.enqueueOrUpdate(source, 0);
+    while (!w.pq.isEmpty()) {
+        int v = w.pq.extractMin().index;
+        w.delta[v] = -1; // marks v as settled until the accumulation pass resets it
+        w.order.push_back(v);
+        for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            int u = g.targets[e];
+            double candidate = w.dist[v] + g.costs[e];
+            if (w.delta[u] < 0) continue;
+            if (candidate < w.dist[u]) {
+                w.dist[u] = candidate;
+                w.sigma[u] = w.sigma[v];
+                w.pq.enqueueOrUpdate(u, candidate);
+            } else if (candidate == w.dist[u]) {
+                w.sigma[u] += w.sigma[v];
+            }
+        }
+    }
+}
+
+// walks the settled vertices from farthest to nearest, pushing dependencies
+// back along shortest-path edges, then clears everything the search touched
+static void accumulate(const CompactGraph& g, int source, bool weighted, double scale,
+                       BrandesWorkspace& w) {
+    for (int v : w.order) w.delta[v] = 0;
+    for (int i = (int) w.order.size() - 1; i >= 0; i--) {
+        int v = w.order[i];
+        double sum = 0;
+        for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            int u = g.targets[e];
+            double step = weighted ? g.costs[e] : 1;
+            if (w.dist[u] == w.dist[v] + step && w.dist[u] != kUnreached) {
+                sum += (1 + w.delta[u]) / w.sigma[u];
+            }
+        }
+        w.delta[v] = w.sigma[v] * sum;
+        if (v != source) w.scores[v] += scale * w.delta[v];
+    }
+    for (int v : w.order) {
+        w.dist[v] = kUnreached;
+        w.sigma[v] = 0;
+        w.delta[v] = 0;
+    }
+    w.order.clear();
+}
+
+int samplesForErrorBound(int numVertices, double epsilon, double delta) {
+    return (int) ceil(log(2.0 * numVertices / delta) / (2 * epsilon * epsilon));
+}
+
+BetweennessResult computeBetweenness(const CompactGraph& g, const BetweennessOptions& options) {
+    int n = g.numVertices();
+    BetweennessResult result;
+    result.scores.assign(n, 0);
+    result.errorBound = 0;
+
+    vector<int> sources(n);
+    for (int v = 0; v < n; v++) sources[v] = v;
+    int numSources = n;
+    if (options.numSamples > 0 && options.numSamples < n) {
+        // partial Fisher-Yates shuffle picks numSamples distinct sources
+        mt19937 rng(options.seed);
+        numSources = options.numSamples;
+        for (int i = 0; i < numSources; i++) {
+            uniform_int_distribution<int> pick(i, n - 1);
+            swap(sources[i], sources[pick(rng)]);
+        }
+        result.errorBound = sqrt(log(2.0 * n / options.delta) / (2.0 * numSources))
+                            * n * max(0, n - 2);
+    }
+    result.sourcesUsed = numSources;
+    double scale = (double) n / max(1, numSources);
+
+    int numThreads = min(resolveThreadCount(options.numThreads), max(1, numSources));
+    vector<BrandesWorkspace> workspaces(numThreads);
+    for (BrandesWorkspace& w : workspaces) {
+        w.dist.assign(n, kUnreached);
+        w.sigma.assign(n, 0);
+        w.delta.assign(n, 0);
+        w.scores.assign(n, 0);
+        w.order.reserve(n);
+        w.pq = HeapPQueuePR<int, double>(n);
+    }
+
+    parallelFor(0, numSources, 1, [&](int t, int lo, int hi) {
+        BrandesWorkspace& w = workspaces[t];
+        for (int i = lo; i < hi; i++) {
+            if (options.weighted) {
+                searchWeighted(g, sources[i], w);
+            } else {
+                searchUnweighted(g, sources[i], w);
+            }
+            accumulate(g, sources[i], options.weighted, scale, w);
+        }
+    }, numThreads);
+
+    for (const BrandesWorkspace& w : workspaces) {
+        for (int v = 0; v < n; v++) result.scores[v] += w.scores[v];
+    }
+    return result;
+}
@@ -0,0 +1,62 @@
+/**
+ * File: betweenness.h
+ * -------------------
+ * Exports Brandes' algorithm for betweenness centrality over a CompactGraph.
+ * Pages with high betweenness sit on many shortest paths between other
+ * pages, which makes them the bridges between otherwise separate topics.
+ */
+
+#pragma once
+#include <vector>
+#include "compact-graph.h"
+
+/**
+ * Type: BetweennessOptions
+ * ------------------------
+ * weighted chooses Dijkstra over arc costs instead of BFS over hops.
+ * numSamples of 0 runs the exact algorithm from every vertex; otherwise
+ * that many distinct sources are drawn at random (using seed) and the
+ * result is scaled up to estimate the exact scores, with errorBound holding
+ * at probability 1 - delta.  numThreads of 0 uses every hardware thread.
+ */
+struct BetweennessOptions {
+    bool weighted = false;
+    int numSamples = 0;
+    double delta = 0.05;
+    unsigned int seed = 1;
+    int numThreads = 0;
+};
+
+/**
+ * Type: BetweennessResult
+ * -----------------------
+ * scores[v] is the (estimated) betweenness of v, counting ordered pairs of
+ * endpoints, so graphs built with bidirectional arcs count each pair twice.
+ * When sampled, errorBound is the Hoeffding bound such that every score is
+ * within errorBound of the exact one with probability at least
+ * 1 - options.delta (see samplesForErrorBound).  It is 0 for exact runs.
+ */
+struct BetweennessResult {
+    std::vector<double> scores;
+    int sourcesUsed;
+    double errorBound;
+};
+
+/**
+ * Function: computeBetweenness
+ * ----------------------------
+ * Runs Brandes' algorithm, spreading the single-source searches across
+ * threads.  Each thread keeps its own dependency accumulator, and the
+ * accumulators are summed once every source is done.
+ */
+BetweennessResult computeBetweenness(const CompactGraph& g,
+                                     const BetweennessOptions& options = BetweennessOptions());
+
+/**
+ * Function: samplesForErrorBound
+ * ------------------------------
+ * Returns how many sampled sources are needed so that, with probability at
+ * least 1 - delta, every estimated score is within epsilon * n * (n - 2) of
+ * its exact value (epsilon is the error in normalized betweenness).
+ */
+int samplesForErrorBound(int numVertices, double epsilon, double delta);
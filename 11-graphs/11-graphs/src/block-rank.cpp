@@ -0,0 +1,97 @@
+#include "block-rank.h"
+#include <algorithm>
+#include "parallel.h"
+using namespace std;
+
+vector<double> estimateBlockRank(const CompactGraph& g, const vector<int>& block,
+                                 const RankOptions& options, double localTolerance,
+                                 BlockRankStats *stats) {
+    int n = g.numVertices();
+    // relabel the blocks 0 .. k-1 and give each vertex an ID within its block
+    int maxLabel = -1;
+    for (int label : block) maxLabel = max(maxLabel, label);
+    vector<int> blockOf(maxLabel + 1, -1);
+    int k = 0;
+    for (int label : block) {
+        if (blockOf[label] < 0) blockOf[label] = k++;
+    }
+    vector<vector<int>> members(k);
+    vector<int> local(n);
+    for (int v = 0; v < n; v++) {
+        vector<int>& mine = members[blockOf[block[v]]];
+        local[v] = mine.size();
+        mine.push_back(v);
+    }
+
+    // local PageRank of each block over its internal links, largest blocks first
+    vector<int> bySize(k);
+    for (int b = 0; b < k; b++) bySize[b] = b;
+    sort(bySize.begin(), bySize.end(), [&members](int a, int b) {
+        return members[a].size() > members[b].size();
+    });
+    vector<double> localRank(n);
+    vector<int> localIterations(k, 0);
+    RankOptions localOptions = options;
+    localOptions.tolerance = localTolerance;
+    localOptions.numThreads = 1;
+    // only the global solve may checkpoint; the local solves would all write the same file
+    localOptions.checkpointFile.clear();
+    parallelFor(0, k, 1, [&](int, int lo, int hi) {
+        for (int i = lo; i < hi; i++) {
+            int b = bySize[i];
+            vector<WeightedEdge> edges;
+            for (int v : members[b]) {
+                for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+                    int u = g.targets[e];
+                    if (blockOf[block[u]] == b) edges.push_back({local[v], local[u], 1});
+                }
+            }
+            RankEngine engine(buildCompactGraph(members[b].size(), edges));
+            RankResult result = engine.solve(localOptions);
+            for (int v : members[b]) localRank[v] = result.ranks[local[v]];
+            localIterations[b] = result.iterations;
+        }
+    }, options.numThreads);
+
+    // block graph: block I links to block J with the local rank I sends to J
+    vector<WeightedEdge> blockEdges;
+    vector<double> weight(k, 0);
+    vector<int> touched;
+    for (int b = 0; b < k; b++) {
+        for (int v : members[b]) {
+            if (g.outDegree(v) == 0) continue;
+            double share = localRank[v] / g.outDegree(v);
+            for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+                int target = blockOf[block[g.targets[e]]];
+                if (weight[target] == 0) touched.push_back(target);
+                weight[target] += share;
+            }
+        }
+        for (int target : touched) {
+            blockEdges.push_back({b, target, weight[target]});
+            weight[target] = 0;
+        }
+        touched.clear();
+    }
+    RankEngine blockEngine(buildCompactGraph(k, blockEdges), /* weighted = */ true);
+    RankOptions blockOptions = options;
+    blockOptions.checkpointFile.clear();
+    RankResult blockRank = blockEngine.solve(blockOptions);
+
+    vector<double> estimate(n);
+    for (int v = 0; v < n; v++) estimate[v] = blockRank.ranks[blockOf[block[v]]] * localRank[v];
+    if (stats != nullptr) {
+        stats->numBlocks = k;
+        stats->localIterations = k > 0 ? *max_element(localIterations.begin(), localIterations.end()) : 0;
+        stats->blockIterations = blockRank.iterations;
+    }
+    return estimate;
+}
+
+RankResult solveBlockRank(const RankEngine& engine, const CompactGraph& g, const vector<int>& block,
+                          const RankOptions& options, BlockRankStats *stats) {
+    vector<double> estimate = estimateBlockRank(g, block, options, 1e-6, stats);
+    RankResult result = engine.solve(options, estimate);
+    if (stats != nullptr) stats->globalIterations = result.iterations;
+    return result;
+}
@@ -0,0 +1,52 @@
+/**
+ * File: block-rank.h
+ * ------------------
+ * Exports BlockRank (Kamvar et al.): when pages fall into blocks that link
+ * mostly among themselves (a dataset, a topic, a strongly connected
+ * component), the PageRank of a page is close to its rank within its block
+ * times the rank of the block.  That product is cheap to compute and makes
+ * a far better starting point for the global iteration than uniform.
+ */
+
+#pragma once
+#include <vector>
+#include "compact-graph.h"
+#include "rank-engine.h"
+
+/**
+ * Type: BlockRankStats
+ * --------------------
+ * Iteration counts from each stage of solveBlockRank: the most any local
+ * solve needed, the block-graph solve, and the final global solve.
+ */
+struct BlockRankStats {
+    int numBlocks;
+    int localIterations;
+    int blockIterations;
+    int globalIterations;
+};
+
+/**
+ * Function: estimateBlockRank
+ * ---------------------------
+ * block[v] is the block of vertex v (any non-negative labels).  Computes
+ * the local PageRank of every block over its internal links (blocks are
+ * solved in parallel), ranks the blocks on the block graph whose link
+ * weights are the local rank each block sends to the others, and returns
+ * the product as an estimate of the global ranks.  localTolerance applies
+ * to the local solves, which only need to be roughly right.
+ */
+std::vector<double> estimateBlockRank(const CompactGraph& g, const std::vector<int>& block,
+                                      const RankOptions& options, double localTolerance = 1e-6,
+                                      BlockRankStats *stats = nullptr);
+
+/**
+ * Function: solveBlockRank
+ * ------------------------
+ * Runs estimateBlockRank and finishes with the global iteration on engine
+ * (which must have been built from g) warm-started from the estimate.
+ * Only the global iteration uses options.checkpointFile, so the file holds
+ * global ranks that a later engine.solve(options) can resume from.
+ */
+RankResult solveBlockRank(const RankEngine& engine, const CompactGraph& g, const std::vector<int>& block,
+                          const RankOptions& options, BlockRankStats *stats = nullptr);
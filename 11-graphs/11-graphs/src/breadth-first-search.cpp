@@ -0,0 +1,136 @@
+#include "breadth-first-search.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "engine-error.h"
+#include "parallel.h"
+using namespace std;
+
+// top-down frontier vertices are handed to threads in chunks of this many
+static const int kGrain = 256;
+
+// bottom-up steps hand out this many 64-vertex bitmap words at a time
+static const int kWordGrain = 64;
+
+// switch to bottom-up once the frontier's edges exceed 1/kAlpha of the unexplored edges
+static const int kAlpha = 15;
+
+// switch back to top-down once the frontier shrinks below 1/kBeta of the vertices
+static const int kBeta = 18;
+
+BfsEngine::BfsEngine(const CompactGraph& g) : outgoing(g), incoming(transposeGraph(g)) {
+    // the search only needs the structure
+    outgoing.costs.clear();
+    outgoing.arcs.clear();
+    incoming.costs.clear();
+    incoming.arcs.clear();
+}
+
+BfsTree BfsEngine::search(int source, int numThreads) const {
+    int n = numVertices();
+    if (source < 0 || source >= n) error("BfsEngine::search: source out of range");
+    numThreads = resolveThreadCount(numThreads);
+    int numWords = (n + 63) / 64;
+
+    BfsTree tree;
+    tree.source = source;
+    tree.hops.assign(n, -1);
+    unique_ptr<atomic<int>[]> parent(new atomic<int>[n]);
+    for (int v = 0; v < n; v++) parent[v].store(-1, memory_order_relaxed);
+    tree.hops[source] = 0;
+    parent[source].store(source, memory_order_relaxed);
+
+    vector<int> queue(1, source);
+    vector<uint64_t> frontier, next;
+    bool bottomUp = false;
+    long long frontierEdges = outgoing.outDegree(source);
+    long long unexploredEdges = (long long) outgoing.numEdges() - frontierEdges;
+    long long frontierSize = 1;
+    atomic<long long> examined(0);
+    vector<vector<int>> found(numThreads);
+
+    for (int depth = 1; frontierSize > 0; depth++) {
+        if (!bottomUp && frontierEdges > unexploredEdges / kAlpha) {
+            bottomUp = true;
+            frontier.assign(numWords, 0);
+            for (int v : queue) frontier[v >> 6] |= uint64_t(1) << (v & 63);
+        } else if (bottomUp && frontierSize < n / kBeta) {
+            bottomUp = false;
+            queue.clear();
+            for (int v = 0; v < n; v++) {
+                if (frontier[v >> 6] >> (v & 63) & 1) queue.push_back(v);
+            }
+        }
+
+        atomic<long long> nextSize(0), nextEdges(0);
+        if (bottomUp) {
+            next.assign(numWords, 0);
+            // each chunk owns whole words of next, so no bit is written by two threads
+            parallelFor(0, numWords, kWordGrain, [&](int, int lo, int hi) {
+                long long size = 0, edges = 0, looked = 0;
+                for (int v = lo * 64; v < min(n, hi * 64); v++) {
+                    if (tree.hops[v] >= 0) continue;
+                    for (size_t e = incoming.offsets[v]; e < incoming.offsets[v + 1]; e++) {
+                        int u = incoming.targets[e];
+                        looked++;
+                        if (frontier[u >> 6] >> (u & 63) & 1) {
+                            parent[v].store(u, memory_order_relaxed);
+                            tree.hops[v] = depth;
+                            next[v >> 6] |= uint64_t(1) << (v & 63);
+                            size++;
+                            edges += outgoing.outDegree(v);
+                            break;
+                        }
+                    }
+                }
+                nextSize.fetch_add(size);
+                nextEdges.fetch_add(edges);
+                examined.fetch_add(looked);
+            }, numThreads);
+            frontier.swap(next);
+        } else {
+            parallelFor(0, queue.size(), kGrain, [&](int t, int lo, int hi) {
+                long long edges = 0, looked = 0;
+                for (int i = lo; i < hi; i++) {
+                    int v = queue[i];
+                    for (size_t e = outgoing.offsets[v]; e < outgoing.offsets[v + 1]; e++) {
+                        int u = outgoing.targets[e];
+                        looked++;
+                        if (parent[u].load(memory_order_relaxed) >= 0) continue;
+                        int unclaimed = -1;
+                        if (parent[u].compare_exchange_strong(unclaimed, v, memory_order_relaxed)) {
+                            tree.hops[u] = depth;
+                            found[t].push_back(u);
+                            edges += outgoing.outDegree(u);
+                        }
+                    }
+                }
+                nextEdges.fetch_add(edges);
+                examined.fetch_add(looked);
+            }, numThreads);
+            queue.clear();
+            for (vector<int>& part : found) {
+                queue.insert(queue.end(), part.begin(), part.end());
+                part.clear();
+            }
+            nextSize.store(queue.size());
+        }
+        frontierSize = nextSize.load();
+        frontierEdges = nextEdges.load();
+        unexploredEdges -= frontierEdges;
+    }
+
+    tree.parent.resize(n);
+    tree.numReached = 0;
+    tree.maxHops = 0;
+    for (int v = 0; v < n; v++) {
+        tree.parent[v] = v == source ? -1 : parent[v].load(memory_order_relaxed);
+        if (tree.hops[v] >= 0) {
+            tree.numReached++;
+            tree.maxHops = max(tree.maxHops, tree.hops[v]);
+        }
+    }
+    tree.edgesExamined = examined.load();
+    return tree;
+}
@@ -0,0 +1,62 @@
+/**
+ * File: breadth-first-search.h
+ * ----------------------------
+ * Exports a parallel, direction-optimizing breadth-first search over a
+ * CompactGraph (Beamer, Asanovic and Patterson).  While the frontier is
+ * small, each frontier vertex pushes along its out-edges (top-down); once
+ * the frontier's edges outnumber a fraction of the unexplored ones, every
+ * unvisited vertex instead looks back along its in-edges for any parent in
+ * the frontier and stops at the first it finds (bottom-up), which skips
+ * most of the edges into an already-visited giant component.  Bottom-up
+ * frontiers are bitmaps, one bit per vertex.
+ */
+
+#pragma once
+#include <vector>
+#include "compact-graph.h"
+
+/**
+ * Type: BfsTree
+ * -------------
+ * hops[v] is the number of links on a shortest path from source to v (-1
+ * if v is unreachable) and parent[v] the vertex before v on one such path
+ * (-1 for the source and unreachable vertices).  maxHops is the
+ * eccentricity of the source over what it reaches, and edgesExamined counts
+ * the edges actually looked at, for working out traversal rates.
+ */
+struct BfsTree {
+    int source;
+    std::vector<int> hops;
+    std::vector<int> parent;
+    int numReached;
+    int maxHops;
+    long long edgesExamined;
+};
+
+/**
+ * Class: BfsEngine
+ * ----------------
+ * Keeps both the out-edges and the in-edges of a graph, since bottom-up
+ * steps walk the latter, so repeated searches over one graph (for
+ * eccentricities or betweenness) build them only once.
+ */
+class BfsEngine {
+public:
+    BfsEngine(const CompactGraph& g);
+
+    /**
+     * Method: search
+     * --------------
+     * Runs a breadth-first search from source on numThreads threads.  The
+     * hop distances are the same whichever direction each step runs in;
+     * when several parents are equally good, which one is recorded depends
+     * on thread timing.
+     */
+    BfsTree search(int source, int numThreads = 0) const;
+
+    int numVertices() const { return outgoing.numVertices(); }
+
+private:
+    CompactGraph outgoing;
+    CompactGraph incoming;
+};
@@ -0,0 +1,255 @@
+#include "communities.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include "parallel.h"
+using namespace std;
+
+// vertices are handed to threads in chunks of this many
+static const int kGrain = 256;
+
+// the undirected weighted graph one Louvain level works on: each link appears
+// in both endpoints' lists, a self loop holds the links folded inside a coarse
+// vertex, degree[v] is the total weight at v and totalWeight is 2m
+struct LevelGraph {
+    vector<size_t> offsets;
+    vector<int> targets;
+    vector<double> weights;
+    vector<double> degree;
+    double totalWeight;
+
+    int numVertices() const { return (int) offsets.size() - 1; }
+};
+
+// fills in degree and totalWeight from the adjacency
+static void computeDegrees(LevelGraph& lg) {
+    int n = lg.numVertices();
+    lg.degree.assign(n, 0);
+    lg.totalWeight = 0;
+    for (int v = 0; v < n; v++) {
+        for (size_t e = lg.offsets[v]; e < lg.offsets[v + 1]; e++) lg.degree[v] += lg.weights[e];
+        lg.totalWeight += lg.degree[v];
+    }
+}
+
+// adds every link in both directions and merges duplicates
+static LevelGraph symmetrize(const CompactGraph& g) {
+    vector<WeightedEdge> edges;
+    edges.reserve(2 * g.numEdges());
+    for (int v = 0; v < g.numVertices(); v++) {
+        for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            edges.push_back({v, g.targets[e], g.costs[e]});
+            edges.push_back({g.targets[e], v, g.costs[e]});
+        }
+    }
+    CompactGraph both = buildCompactGraph(g.numVertices(), edges);
+    LevelGraph lg;
+    lg.offsets.push_back(0);
+    for (int v = 0; v < both.numVertices(); v++) {
+        for (size_t e = both.offsets[v]; e < both.offsets[v + 1]; e++) {
+            if (lg.targets.size() > lg.offsets[v] && lg.targets.back() == both.targets[e]) {
+                lg.weights.back() += both.costs[e];
+            } else {
+                lg.targets.push_back(both.targets[e]);
+                lg.weights.push_back(both.costs[e]);
+            }
+        }
+        lg.offsets.push_back(lg.targets.size());
+    }
+    computeDegrees(lg);
+    return lg;
+}
+
+// adds delta to an atomic double
+static void atomicAdd(atomic<double>& target, double delta) {
+    double current = target.load(memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + delta, memory_order_relaxed)) {}
+}
+
+// per-thread scratch: weight from the current vertex to each community
+struct MoveWorkspace {
+    vector<double> weightTo;
+    vector<int> touched;
+};
+
+// the local-move phase: vertices repeatedly join the neighbouring community
+// with the best modularity gain; community[v] starts as v and ends holding
+// the chosen community.  Moves are applied immediately with atomics, so
+// later vertices in a sweep already see earlier moves.
+static void moveVertices(const LevelGraph& lg, vector<int>& community, const CommunityOptions& options) {
+    int n = lg.numVertices();
+    int numThreads = resolveThreadCount(options.numThreads);
+    unique_ptr<atomic<int>[]> comm(new atomic<int>[n]);
+    unique_ptr<atomic<int>[]> size(new atomic<int>[n]);
+    unique_ptr<atomic<double>[]> total(new atomic<double>[n]);
+    for (int v = 0; v < n; v++) {
+        comm[v].store(v, memory_order_relaxed);
+        size[v].store(1, memory_order_relaxed);
+        total[v].store(lg.degree[v], memory_order_relaxed);
+    }
+    vector<MoveWorkspace> workspaces(numThreads);
+    for (MoveWorkspace& w : workspaces) w.weightTo.assign(n, 0);
+    double penalty = options.resolution / max(lg.totalWeight, 1e-300);
+
+    for (int sweep = 0; sweep < options.maxSweeps; sweep++) {
+        atomic<int> moved(0);
+        parallelFor(0, n, kGrain, [&](int t, int lo, int hi) {
+            MoveWorkspace& w = workspaces[t];
+            int movedHere = 0;
+            for (int v = lo; v < hi; v++) {
+                int current = comm[v].load(memory_order_relaxed);
+                for (size_t e = lg.offsets[v]; e < lg.offsets[v + 1]; e++) {
+                    int u = lg.targets[e];
+                    if (u == v) continue;
+                    int c = comm[u].load(memory_order_relaxed);
+                    if (w.weightTo[c] == 0) w.touched.push_back(c);
+                    w.weightTo[c] += lg.weights[e];
+                }
+                // gain of joining c, up to terms that are the same for every c
+                double kv = lg.degree[v];
+                int best = current;
+                double bestScore = w.weightTo[current]
+                                   - penalty * kv * (total[current].load(memory_order_relaxed) - kv);
+                bool alone = size[current].load(memory_order_relaxed) == 1;
+                for (int c : w.touched) {
+                    if (c == current) continue;
+                    // two singletons trading places forever is avoided by only moving to lower labels
+                    if (alone && size[c].load(memory_order_relaxed) == 1 && c > current) continue;
+                    double score = w.weightTo[c] - penalty * kv * total[c].load(memory_order_relaxed);
+                    if (score > bestScore) {
+                        bestScore = score;
+                        best = c;
+                    }
+                }
+                for (int c : w.touched) w.weightTo[c] = 0;
+                w.touched.clear();
+
+                if (best == current) continue;
+                comm[v].store(best, memory_order_relaxed);
+                atomicAdd(total[current], -kv);
+                atomicAdd(total[best], kv);
+                size[current].fetch_sub(1, memory_order_relaxed);
+                size[best].fetch_add(1, memory_order_relaxed);
+                movedHere++;
+            }
+            moved.fetch_add(movedHere);
+        }, numThreads);
+        if (moved.load() <= options.minMovedFraction * n) break;
+    }
+    for (int v = 0; v < n; v++) community[v] = comm[v].load(memory_order_relaxed);
+}
+
+// renumbers the labels in community to 0 .. k-1 and returns k
+static int compactLabels(vector<int>& community) {
+    vector<int> newLabel(community.size(), -1);
+    int k = 0;
+    for (int& label : community) {
+        if (newLabel[label] < 0) newLabel[label] = k++;
+        label = newLabel[label];
+    }
+    return k;
+}
+
+// collapses each of the k communities into one vertex, summing the link
+// weights between (and within) communities; communities are aggregated in parallel
+static LevelGraph coarsen(const LevelGraph& lg, const vector<int>& community, int k, int numThreads) {
+    int n = lg.numVertices();
+    vector<int> start(k + 1, 0);
+    for (int v = 0; v < n; v++) start[community[v] + 1]++;
+    for (int c = 0; c < k; c++) start[c + 1] += start[c];
+    vector<int> members(n);
+    vector<int> cursor(start.begin(), start.end() - 1);
+    for (int v = 0; v < n; v++) members[cursor[community[v]]++] = v;
+
+    vector<vector<int>> targets(k);
+    vector<vector<double>> weights(k);
+    numThreads = resolveThreadCount(numThreads);
+    vector<MoveWorkspace> workspaces(numThreads);
+    for (MoveWorkspace& w : workspaces) w.weightTo.assign(k, 0);
+    parallelFor(0, k, 64, [&](int t, int lo, int hi) {
+        MoveWorkspace& w = workspaces[t];
+        for (int c = lo; c < hi; c++) {
+            for (int i = start[c]; i < start[c + 1]; i++) {
+                int v = members[i];
+                for (size_t e = lg.offsets[v]; e < lg.offsets[v + 1]; e++) {
+                    int d = community[lg.targets[e]];
+                    if (w.weightTo[d] == 0) w.touched.push_back(d);
+                    w.weightTo[d] += lg.weights[e];
+                }
+            }
+            sort(w.touched.begin(), w.touched.end());
+            for (int d : w.touched) {
+                targets[c].push_back(d);
+                weights[c].push_back(w.weightTo[d]);
+                w.weightTo[d] = 0;
+            }
+            w.touched.clear();
+        }
+    }, numThreads);
+
+    LevelGraph coarse;
+    coarse.offsets.push_back(0);
+    for (int c = 0; c < k; c++) {
+        coarse.targets.insert(coarse.targets.end(), targets[c].begin(), targets[c].end());
+        coarse.weights.insert(coarse.weights.end(), weights[c].begin(), weights[c].end());
+        coarse.offsets.push_back(coarse.targets.size());
+    }
+    computeDegrees(coarse);
+    return coarse;
+}
+
+// modularity of a partition of the level-0 graph
+static double modularity(const LevelGraph& lg, const vector<int>& community, int k, double resolution) {
+    vector<double> inside(k, 0), total(k, 0);
+    for (int v = 0; v < lg.numVertices(); v++) {
+        total[community[v]] += lg.degree[v];
+        for (size_t e = lg.offsets[v]; e < lg.offsets[v + 1]; e++) {
+            if (community[lg.targets[e]] == community[v]) inside[community[v]] += lg.weights[e];
+        }
+    }
+    if (lg.totalWeight <= 0) return 0;
+    double q = 0;
+    for (int c = 0; c < k; c++) {
+        double share = total[c] / lg.totalWeight;
+        q += inside[c] / lg.totalWeight - resolution * share * share;
+    }
+    return q;
+}
+
+Communities detectCommunities(const CompactGraph& g, const CommunityOptions& options) {
+    int n = g.numVertices();
+    LevelGraph base = symmetrize(g);
+    LevelGraph level = base;
+    Communities result;
+    result.community.resize(n);
+    for (int v = 0; v < n; v++) result.community[v] = v;
+    result.levels = 0;
+
+    int k = n;
+    for (int l = 0; l < options.maxLevels; l++) {
+        vector<int> community(level.numVertices());
+        moveVertices(level, community, options);
+        int merged = compactLabels(community);
+        result.levels++;
+        for (int& label : result.community) label = community[label];
+        if (merged == k) break;
+        k = merged;
+        level = coarsen(level, community, k, options.numThreads);
+    }
+
+    // renumber so community 0 is the largest
+    k = compactLabels(result.community);
+    vector<int> sizes(k, 0);
+    for (int c : result.community) sizes[c]++;
+    vector<int> bySize(k);
+    for (int c = 0; c < k; c++) bySize[c] = c;
+    stable_sort(bySize.begin(), bySize.end(), [&sizes](int a, int b) { return sizes[a] > sizes[b]; });
+    vector<int> rankOf(k);
+    for (int i = 0; i < k; i++) rankOf[bySize[i]] = i;
+    for (int& c : result.community) c = rankOf[c];
+    result.sizes.resize(k);
+    for (int i = 0; i < k; i++) result.sizes[i] = sizes[bySize[i]];
+    result.numCommunities = k;
+    result.modularity = modularity(base, result.community, k, options.resolution);
+    return result;
+}
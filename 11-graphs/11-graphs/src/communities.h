@@ -0,0 +1,51 @@
+/**
+ * File: communities.h
+ * -------------------
+ * Exports multi-threaded Louvain community detection over a CompactGraph.
+ * Links are treated as undirected, with the edge costs (the same weights
+ * the rank engine reads) as link weights.
+ */
+
+#pragma once
+#include <vector>
+#include "compact-graph.h"
+
+/**
+ * Type: CommunityOptions
+ * ----------------------
+ * resolution scales the modularity penalty for large communities (higher
+ * gives more, smaller communities).  Each level of the local-move phase
+ * stops after maxSweeps sweeps or once a sweep moves fewer than
+ * minMovedFraction of the vertices; the whole algorithm stops after
+ * maxLevels levels or when a level merges nothing.
+ */
+struct CommunityOptions {
+    double resolution = 1.0;
+    int maxLevels = 10;
+    int maxSweeps = 20;
+    double minMovedFraction = 0.001;
+    int numThreads = 0;
+};
+
+/**
+ * Type: Communities
+ * -----------------
+ * community[v] is the community of v, numbered 0 .. numCommunities-1 with
+ * community 0 the largest; modularity is that of the final partition.
+ */
+struct Communities {
+    std::vector<int> community;
+    std::vector<int> sizes;
+    int numCommunities;
+    double modularity;
+    int levels;
+};
+
+/**
+ * Function: detectCommunities
+ * ---------------------------
+ * Runs Louvain: vertices move in parallel to whichever neighbouring
+ * community raises modularity most, then each community is collapsed into
+ * a single vertex of a smaller graph and the process repeats.
+ */
+Communities detectCommunities(const CompactGraph& g, const CommunityOptions& options = CommunityOptions());
@@ -0,0 +1,128 @@
+#include "compact-graph.h"
+#include <algorithm>
+#include <numeric>
+using namespace std;
+
+void sortAdjacencyLists(CompactGraph& g) {
+    int n = g.numVertices();
+    vector<size_t> order;
+    vector<int> targets;
+    vector<double> costs;
+    vector<const arc *> arcs;
+    for (int v = 0; v < n; v++) {
+        size_t lo = g.offsets[v], hi = g.offsets[v + 1];
+        if (is_sorted(g.targets.begin() + lo, g.targets.begin() + hi)) continue;
+        order.resize(hi - lo);
+        iota(order.begin(), order.end(), lo);
+        stable_sort(order.begin(), order.end(), [&g](size_t a, size_t b) {
+            return g.targets[a] < g.targets[b];
+        });
+        targets.clear(); costs.clear(); arcs.clear();
+        for (size_t e : order) {
+            targets.push_back(g.targets[e]);
+            costs.push_back(g.costs[e]);
+            if (!g.arcs.empty()) arcs.push_back(g.arcs[e]);
+        }
+        copy(targets.begin(), targets.end(), g.targets.begin() + lo);
+        copy(costs.begin(), costs.end(), g.costs.begin() + lo);
+        if (!g.arcs.empty()) copy(arcs.begin(), arcs.end(), g.arcs.begin() + lo);
+    }
+}
+
+// counting sort of the edges by source vertex
+CompactGraph buildCompactGraph(int numVertices, const vector<WeightedEdge>& edges) {
+    CompactGraph g;
+    g.offsets.assign(numVertices + 1, 0);
+    for (const WeightedEdge& e : edges) g.offsets[e.from + 1]++;
+    for (int v = 0; v < numVertices; v++) g.offsets[v + 1] += g.offsets[v];
+
+    g.targets.resize(edges.size());
+    g.costs.resize(edges.size());
+    vector<size_t> next(g.offsets.begin(), g.offsets.end() - 1);
+    for (const WeightedEdge& e : edges) {
+        size_t slot = next[e.from]++;
+        g.targets[slot] = e.to;
+        g.costs[slot] = e.cost;
+    }
+    g.names.resize(numVertices);
+    sortAdjacencyLists(g);
+    return g;
+}
+
+CompactGraph transposeGraph(const CompactGraph& g) {
+    int n = g.numVertices();
+    CompactGraph t;
+    t.offsets.assign(n + 1, 0);
+    for (int to : g.targets) t.offsets[to + 1]++;
+    for (int v = 0; v < n; v++) t.offsets[v + 1] += t.offsets[v];
+
+    t.targets.resize(g.numEdges());
+    t.costs.resize(g.numEdges());
+    if (!g.arcs.empty()) t.arcs.resize(g.numEdges());
+    vector<size_t> next(t.offsets.begin(), t.offsets.end() - 1);
+    // walking sources in increasing order leaves every slice already sorted
+    for (int v = 0; v < n; v++) {
+        for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            size_t slot = next[g.targets[e]]++;
+            t.targets[slot] = v;
+            t.costs[slot] = g.costs[e];
+            if (!g.arcs.empty()) t.arcs[slot] = g.arcs[e];
+        }
+    }
+    t.names = g.names;
+    return t;
+}
+
+CompactGraph inducedSubgraph(const CompactGraph& g, const vector<bool>& keep, vector<int> *originalIds) {
+    int n = g.numVertices();
+    vector<int> newId(n, -1);
+    CompactGraph sub;
+    sub.offsets.push_back(0);
+    for (int v = 0; v < n; v++) {
+        if (!keep[v]) continue;
+        newId[v] = sub.names.size();
+        sub.names.push_back(g.names[v]);
+        if (originalIds != nullptr) originalIds->push_back(v);
+    }
+    // relabelling is monotone, so each slice stays sorted
+    for (int v = 0; v < n; v++) {
+        if (!keep[v]) continue;
+        for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            int u = newId[g.targets[e]];
+            if (u < 0) continue;
+            sub.targets.push_back(u);
+            sub.costs.push_back(g.costs[e]);
+            if (!g.arcs.empty()) sub.arcs.push_back(g.arcs[e]);
+        }
+        sub.offsets.push_back(sub.targets.size());
+    }
+    return sub;
+}
+
+CompactGraph undirectedGraph(const CompactGraph& g) {
+    vector<WeightedEdge> edges;
+    edges.reserve(2 * g.numEdges());
+    for (int v = 0; v < g.numVertices(); v++) {
+        for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            if (g.targets[e] == v) continue;
+            edges.push_back({v, g.targets[e], g.costs[e]});
+            edges.push_back({g.targets[e], v, g.costs[e]});
+        }
+    }
+    CompactGraph both = buildCompactGraph(g.numVertices(), edges);
+    CompactGraph simple;
+    simple.names = g.names;
+    simple.offsets.push_back(0);
+    for (int v = 0; v < both.numVertices(); v++) {
+        for (size_t e = both.offsets[v]; e < both.offsets[v + 1]; e++) {
+            if (simple.targets.size() > simple.offsets[v] && simple.targets.back() == both.targets[e]) {
+                simple.costs.back() += both.costs[e];
+            } else {
+                simple.targets.push_back(both.targets[e]);
+                simple.costs.push_back(both.costs[e]);
+            }
+        }
+        simple.offsets.push_back(simple.targets.size());
+    }
+    return simple;
+}
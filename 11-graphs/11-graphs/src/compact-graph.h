@@ -0,0 +1,93 @@
+/**
+ * File: compact-graph.h
+ * ---------------------
+ * Presents a compressed sparse row (CSR) view of a graph over the integer
+ * vertex IDs 0 .. n-1.  The node/arc graph in graphs.h is convenient to
+ * build and draw, but every step through it chases pointers into Sets;
+ * the analyses that touch every edge many times run over this instead.
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct arc;
+
+/**
+ * Type: WeightedEdge
+ * ------------------
+ * A single directed edge used to feed buildCompactGraph.
+ */
+struct WeightedEdge {
+    int from, to;
+    double cost;
+};
+
+/**
+ * Type: CompactGraph
+ * ------------------
+ * The out-edges of vertex v are targets[offsets[v]] .. targets[offsets[v + 1] - 1],
+ * sorted by target, with matching entries in costs.  names[v] is the page
+ * title (or node name) of v, and arcs, when non-empty, maps each edge back
+ * to the arc it was built from so that a GraphDisplay can animate it.
+ */
+struct CompactGraph {
+    std::vector<std::size_t> offsets;
+    std::vector<int> targets;
+    std::vector<double> costs;
+    std::vector<std::string> names;
+    std::vector<const arc *> arcs;
+
+    int numVertices() const { return offsets.empty() ? 0 : (int) offsets.size() - 1; }
+    std::size_t numEdges() const { return targets.size(); }
+    int outDegree(int v) const { return (int) (offsets[v + 1] - offsets[v]); }
+};
+
+/**
+ * Function: buildCompactGraph
+ * ---------------------------
+ * Builds a CompactGraph with numVertices vertices out of the supplied edge
+ * list using a counting sort, so the build is linear in the number of edges.
+ * Edges are kept as given (parallel edges and self loops included).
+ */
+CompactGraph buildCompactGraph(int numVertices, const std::vector<WeightedEdge>& edges);
+
+/**
+ * Function: sortAdjacencyLists
+ * ----------------------------
+ * Sorts every vertex's slice of targets by target, moving the matching
+ * costs and arcs along with it.  Only needed by code that fills in a
+ * CompactGraph by hand.
+ */
+void sortAdjacencyLists(CompactGraph& g);
+
+/**
+ * Function: transposeGraph
+ * ------------------------
+ * Returns the graph with every edge reversed, so that the out-edges of v in
+ * the result are the in-edges of v in g.  Names and costs carry over.
+ */
+CompactGraph transposeGraph(const CompactGraph& g);
+
+/**
+ * Function: inducedSubgraph
+ * -------------------------
+ * Returns the subgraph on the vertices v with keep[v] set, renumbered
+ * 0 .. k-1 in their original order, with only the edges between kept
+ * vertices.  If originalIds is supplied, it receives the old ID of each
+ * new vertex.
+ */
+CompactGraph inducedSubgraph(const CompactGraph& g, const std::vector<bool>& keep,
+                             std::vector<int> *originalIds = nullptr);
+
+/**
+ * Function: undirectedGraph
+ * -------------------------
+ * Returns the simple undirected graph underlying g: every link appears in
+ * both endpoints' slices, self loops are dropped, and parallel links are
+ * merged into one edge whose cost is their sum.  Each slice is therefore
+ * strictly increasing, as the set intersections in triangles.h require.
+ * Names carry over; arcs do not.
+ */
+CompactGraph undirectedGraph(const CompactGraph& g);
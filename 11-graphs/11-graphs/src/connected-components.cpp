@@ -0,0 +1,152 @@
+#include "connected-components.h"
+#include <atomic>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include "parallel.h"
+using namespace std;
+
+// vertices are handed to threads in chunks of this many
+static const int kGrain = 4096;
+
+// how many leading edges per vertex the sampling passes link
+static const int kNeighborRounds = 2;
+
+// vertices sampled to guess which component is the giant one
+static const int kGiantSamples = 1024;
+
+// walks to the root of x, halving the path as it goes; a lost race on the
+// halving store is harmless because parent pointers only ever move rootward
+static int findRoot(atomic<int> *parent, int x) {
+    while (true) {
+        int p = parent[x].load(memory_order_relaxed);
+        if (p == x) return x;
+        int gp = parent[p].load(memory_order_relaxed);
+        if (p != gp) parent[x].compare_exchange_weak(p, gp, memory_order_relaxed);
+        x = gp;
+    }
+}
+
+// hangs the larger of the two roots under the smaller, retrying if another
+// thread moved the root first; always linking downward rules out cycles
+static void link(atomic<int> *parent, int u, int v) {
+    while (true) {
+        int ru = findRoot(parent, u), rv = findRoot(parent, v);
+        if (ru == rv) return;
+        if (ru < rv) swap(ru, rv);
+        int expected = ru;
+        if (parent[ru].compare_exchange_strong(expected, rv)) return;
+    }
+}
+
+// numbers the components by their lowest vertex, given each vertex's lowest-vertex label
+static ConnectedComponents numberComponents(const vector<int>& root) {
+    int n = root.size();
+    ConnectedComponents cc;
+    cc.component.assign(n, -1);
+    cc.numComponents = 0;
+    for (int v = 0; v < n; v++) {
+        if (root[v] == v) {
+            cc.component[v] = cc.numComponents++;
+            cc.sizes.push_back(0);
+        }
+        cc.component[v] = cc.component[root[v]];
+        cc.sizes[cc.component[v]]++;
+    }
+    return cc;
+}
+
+ConnectedComponents findConnectedComponents(const CompactGraph& g, int numThreads, bool symmetric) {
+    int n = g.numVertices();
+    unique_ptr<atomic<int>[]> parent(new atomic<int>[n]);
+    for (int v = 0; v < n; v++) parent[v].store(v, memory_order_relaxed);
+    auto compress = [&]() {
+        parallelFor(0, n, kGrain, [&](int, int lo, int hi) {
+            for (int v = lo; v < hi; v++) parent[v].store(findRoot(parent.get(), v), memory_order_relaxed);
+        }, numThreads);
+    };
+
+    for (int round = 0; round < kNeighborRounds; round++) {
+        parallelFor(0, n, kGrain, [&](int, int lo, int hi) {
+            for (int v = lo; v < hi; v++) {
+                if (g.outDegree(v) > round) link(parent.get(), v, g.targets[g.offsets[v] + round]);
+            }
+        }, numThreads);
+        compress();
+    }
+
+    // the most common root among a sample is almost surely the giant component
+    int giant = -1;
+    if (symmetric && n > 0) {
+        mt19937 rng(n);
+        unordered_map<int, int> counts;
+        int best = 0;
+        for (int i = 0; i < kGiantSamples; i++) {
+            int root = parent[rng() % n].load(memory_order_relaxed);
+            if (++counts[root] > best) {
+                best = counts[root];
+                giant = root;
+            }
+        }
+    }
+
+    parallelFor(0, n, kGrain, [&](int, int lo, int hi) {
+        for (int v = lo; v < hi; v++) {
+            if (giant >= 0 && findRoot(parent.get(), v) == giant) continue;
+            for (size_t e = g.offsets[v] + min(kNeighborRounds, g.outDegree(v)); e < g.offsets[v + 1]; e++) {
+                link(parent.get(), v, g.targets[e]);
+            }
+        }
+    }, numThreads);
+    compress();
+
+    vector<int> root(n);
+    for (int v = 0; v < n; v++) root[v] = parent[v].load(memory_order_relaxed);
+    return numberComponents(root);
+}
+
+// lowers label to candidate unless it is already at least as small
+static bool lowerLabel(atomic<int>& label, int candidate) {
+    int current = label.load(memory_order_relaxed);
+    while (candidate < current) {
+        if (label.compare_exchange_weak(current, candidate, memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+ConnectedComponents labelPropagationComponents(const CompactGraph& g, int numThreads) {
+    int n = g.numVertices();
+    unique_ptr<atomic<int>[]> label(new atomic<int>[n]);
+    for (int v = 0; v < n; v++) label[v].store(v, memory_order_relaxed);
+
+    atomic<bool> changed(true);
+    while (changed.load()) {
+        changed.store(false);
+        parallelFor(0, n, kGrain, [&](int, int lo, int hi) {
+            bool lowered = false;
+            for (int v = lo; v < hi; v++) {
+                for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+                    int u = g.targets[e];
+                    int lv = label[v].load(memory_order_relaxed), lu = label[u].load(memory_order_relaxed);
+                    if (lu < lv) {
+                        lowered |= lowerLabel(label[v], lu);
+                    } else if (lv < lu) {
+                        lowered |= lowerLabel(label[u], lv);
+                    }
+                }
+            }
+            if (lowered) changed.store(true);
+        }, numThreads);
+    }
+
+    vector<int> root(n);
+    for (int v = 0; v < n; v++) root[v] = label[v].load(memory_order_relaxed);
+    return numberComponents(root);
+}
+
+CompactGraph dropSmallComponents(const CompactGraph& g, const ConnectedComponents& cc, int minSize,
+                                 vector<int> *originalIds) {
+    vector<bool> keep(g.numVertices());
+    for (int v = 0; v < g.numVertices(); v++) keep[v] = cc.sizes[cc.component[v]] >= minSize;
+    return inducedSubgraph(g, keep, originalIds);
+}
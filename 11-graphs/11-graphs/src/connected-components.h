@@ -0,0 +1,57 @@
+/**
+ * File: connected-components.h
+ * ----------------------------
+ * Exports parallel algorithms for the (weakly) connected components of a
+ * CompactGraph, where link direction is ignored, and a filter that drops
+ * the small disconnected fragments scraping tends to leave behind.
+ */
+
+#pragma once
+#include <vector>
+#include "compact-graph.h"
+
+/**
+ * Type: ConnectedComponents
+ * -------------------------
+ * component[v] is the component of v, numbered 0 .. numComponents-1 in
+ * order of each component's lowest vertex, and sizes[c] is the number of
+ * vertices in component c.
+ */
+struct ConnectedComponents {
+    std::vector<int> component;
+    std::vector<int> sizes;
+    int numComponents;
+};
+
+/**
+ * Function: findConnectedComponents
+ * ---------------------------------
+ * Uses a lock-free union-find in the style of Afforest: every thread links
+ * the endpoints of its edges with compare-and-swap, always hanging the
+ * larger root under the smaller.  A first pass over only the first couple of
+ * edges of every vertex usually merges almost all of the giant component.
+ * If the graph is symmetric (every link has its reverse, as buildGraph
+ * makes), pass symmetric so the full pass can skip vertices already in the
+ * giant component entirely.
+ */
+ConnectedComponents findConnectedComponents(const CompactGraph& g, int numThreads = 0,
+                                            bool symmetric = false);
+
+/**
+ * Function: labelPropagationComponents
+ * ------------------------------------
+ * Computes the same components by repeatedly lowering each endpoint's label
+ * to the smaller of the two across every edge until nothing changes.  It
+ * needs as many rounds as the graph's diameter, so it is mostly useful as
+ * a check on findConnectedComponents and for low-diameter graphs.
+ */
+ConnectedComponents labelPropagationComponents(const CompactGraph& g, int numThreads = 0);
+
+/**
+ * Function: dropSmallComponents
+ * -----------------------------
+ * Returns the subgraph made of the components with at least minSize
+ * vertices (see inducedSubgraph for originalIds).
+ */
+CompactGraph dropSmallComponents(const CompactGraph& g, const ConnectedComponents& cc, int minSize,
+                                 std::vector<int> *originalIds = nullptr);
@@ -0,0 +1,33 @@
+#include "disjoint-set.h"
+using namespace std;
+
+DisjointSet::DisjointSet(int n) : parent(n), rank(n, 0), sets(n) {
+    for (int i = 0; i < n; i++) parent[i] = i;
+}
+
+// two passes: find the root, then point everything on the path at it
+int DisjointSet::find(int x) {
+    int root = x;
+    while (parent[root] != root) root = parent[root];
+    while (parent[x] != root) {
+        int next = parent[x];
+        parent[x] = root;
+        x = next;
+    }
+    return root;
+}
+
+// hangs the shallower tree under the deeper one
+bool DisjointSet::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return false;
+    if (rank[a] < rank[b]) {
+        parent[a] = b;
+    } else {
+        parent[b] = a;
+        if (rank[a] == rank[b]) rank[a]++;
+    }
+    sets--;
+    return true;
+}
@@ -0,0 +1,45 @@
+/**
+ * File: disjoint-set.h
+ * --------------------
+ * Exports a union-find structure over the integers 0 .. n-1 with path
+ * compression and union by rank, so a sequence of m operations runs in
+ * effectively O(m) time.
+ */
+
+#pragma once
+#include <vector>
+
+/**
+ * Class: DisjointSet
+ * ------------------
+ * Tracks a partition of 0 .. n-1 into sets, starting from n singletons.
+ * Not safe to share between threads, since find rewrites parent links.
+ */
+class DisjointSet {
+public:
+    DisjointSet(int n = 0);
+
+    /**
+     * Method: find
+     * ------------
+     * Returns the representative of the set containing x, pointing every
+     * element on the way directly at it.
+     */
+    int find(int x);
+
+    /**
+     * Method: unite
+     * -------------
+     * Merges the sets containing a and b.  Returns false (and changes nothing)
+     * if they were already in the same set.
+     */
+    bool unite(int a, int b);
+
+    int size() const { return (int) parent.size(); }
+    int numSets() const { return sets; }
+
+private:
+    std::vector<int> parent;
+    std::vector<unsigned char> rank;
+    int sets;
+};
@@ -0,0 +1,27 @@
+/**
+ * File: engine-error.h
+ * --------------------
+ * Gives the graph and rank code its error function.  Inside the Qt
+ * project that is the Stanford library's error; a headless build (one
+ * that defines GRAPHS_HEADLESS and does not link the Stanford library,
+ * such as the benchmark) gets a stand-in that throws the message as a
+ * std::runtime_error instead.
+ */
+
+#pragma once
+
+#ifdef GRAPHS_HEADLESS
+#include <stdexcept>
+#include <string>
+
+/**
+ * Function: error
+ * ---------------
+ * Signals a precondition failure by throwing msg.
+ */
+[[noreturn]] inline void error(const std::string& msg) {
+    throw std::runtime_error(msg);
+}
+#else
+#include "error.h"
+#endif
@@ -0,0 +1,167 @@
+#include "fingerprint-index.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "engine-error.h"
+#include "parallel.h"
+using namespace std;
+
+// vertices are handed to threads in chunks of this many
+static const int kGrain = 1024;
+
+// identifies an index file, and its layout version
+static const char kMagic[8] = {'P', 'P', 'R', 'F', 'P', 'I', 'X', '1'};
+
+// the fixed-size start of an index file; the endpoints follow it directly
+struct FingerprintHeader {
+    char magic[8];
+    int32_t vertices;
+    int32_t walks;
+    double bias;
+};
+
+// a small, fast generator (xorshift64*) for the walks, seeded per vertex
+struct WalkRandom {
+    uint64_t state;
+
+    WalkRandom(uint64_t seed, uint64_t stream) {
+        // splitmix64 spreads nearby seeds across the state space
+        uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (stream + 1);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        state = (z ^ (z >> 31)) | 1;
+    }
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    // uniform in [0, 1)
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+FingerprintIndex::FingerprintIndex(const CompactGraph& g, const FingerprintOptions& options)
+    : vertices(g.numVertices()), walks(options.walksPerVertex), teleport(options.bias),
+      mapping(nullptr), mappingSize(0) {
+    if (walks <= 0) error("FingerprintIndex: walksPerVertex must be positive");
+    if (teleport <= 0 || teleport > 1) error("FingerprintIndex: bias must be in (0, 1]");
+    built.resize((size_t) vertices * walks);
+    parallelFor(0, vertices, kGrain, [&](int, int lo, int hi) {
+        for (int v = lo; v < hi; v++) {
+            WalkRandom random(options.seed, v);
+            int32_t *row = built.data() + (size_t) v * walks;
+            for (int w = 0; w < walks; w++) {
+                int at = v;
+                while (random.uniform() >= teleport) {
+                    int links = g.outDegree(at);
+                    at = links == 0 ? v : g.targets[g.offsets[at] + random.next() % links];
+                }
+                row[w] = at;
+            }
+            // sorted rows read better and compress well if the file is archived
+            sort(row, row + walks);
+        }
+    }, options.numThreads);
+    endpoints = built.data();
+}
+
+// the number of endpoints header promises, or -1 if it is not an index header
+static long long headerEndpoints(const FingerprintHeader& header) {
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.vertices < 0 || header.walks <= 0) return -1;
+    return (long long) header.vertices * header.walks;
+}
+
+FingerprintIndex::FingerprintIndex(const string& fileName) : mapping(nullptr), mappingSize(0) {
+    FingerprintHeader header;
+#ifdef _WIN32
+    // no mmap here; read the whole file instead
+    ifstream stream(fileName.c_str(), ios::binary);
+    if (!stream.read((char *) &header, sizeof(header))) error("FingerprintIndex: cannot read " + fileName);
+    long long count = headerEndpoints(header);
+    if (count < 0) error("FingerprintIndex: " + fileName + " is not an index");
+    built.resize(count);
+    if (!stream.read((char *) built.data(), count * sizeof(int32_t))) error("FingerprintIndex: " + fileName + " is truncated");
+    endpoints = built.data();
+#else
+    // the header is checked before mapping, so a bad file leaves nothing open behind the error
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) error("FingerprintIndex: cannot open " + fileName);
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(header)
+            || pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)) {
+        ::close(fd);
+        error("FingerprintIndex: cannot read " + fileName);
+    }
+    long long count = headerEndpoints(header);
+    if (count < 0) {
+        ::close(fd);
+        error("FingerprintIndex: " + fileName + " is not an index");
+    }
+    if ((size_t) info.st_size < sizeof(header) + count * sizeof(int32_t)) {
+        ::close(fd);
+        error("FingerprintIndex: " + fileName + " is truncated");
+    }
+    mappingSize = info.st_size;
+    mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        error("FingerprintIndex: cannot map " + fileName);
+    }
+    endpoints = (const int32_t *) ((const char *) mapping + sizeof(header));
+#endif
+    vertices = header.vertices;
+    walks = header.walks;
+    teleport = header.bias;
+}
+
+FingerprintIndex::~FingerprintIndex() {
+#ifndef _WIN32
+    if (mapping != nullptr) munmap(mapping, mappingSize);
+#endif
+}
+
+void FingerprintIndex::save(const string& fileName) const {
+    FingerprintHeader header;
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.vertices = vertices;
+    header.walks = walks;
+    header.bias = teleport;
+    ofstream stream(fileName.c_str(), ios::binary);
+    stream.write((const char *) &header, sizeof(header));
+    stream.write((const char *) endpoints, (size_t) vertices * walks * sizeof(int32_t));
+    if (!stream) error("FingerprintIndex::save: cannot write " + fileName);
+}
+
+vector<pair<int, double>> FingerprintIndex::estimate(const vector<int>& seeds, int count) const {
+    if (seeds.empty()) error("FingerprintIndex::estimate: no seeds");
+    double share = 1.0 / ((double) seeds.size() * walks);
+    unordered_map<int, double> totals;
+    for (int s : seeds) {
+        if (s < 0 || s >= vertices) error("FingerprintIndex::estimate: seed out of range");
+        const int32_t *row = endpoints + (size_t) s * walks;
+        for (int w = 0; w < walks; w++) totals[row[w]] += share;
+    }
+
+    vector<pair<int, double>> ranks(totals.begin(), totals.end());
+    auto better = [](const pair<int, double>& a, const pair<int, double>& b) {
+        return a.second > b.second || (a.second == b.second && a.first < b.first);
+    };
+    if (count > 0 && (int) ranks.size() > count) {
+        partial_sort(ranks.begin(), ranks.begin() + count, ranks.end(), better);
+        ranks.resize(count);
+    } else {
+        sort(ranks.begin(), ranks.end(), better);
+    }
+    return ranks;
+}
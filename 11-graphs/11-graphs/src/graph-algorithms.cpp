@@ -0,0 +1,77 @@
+/**
+ * File: graph-algorithms.cpp
+ * --------------------------
+ * Adapts the CompactGraph engines to the node/arc graph and GraphDisplay.
+ */
+
+#include "graph-algorithms.h"
+#include <iostream>
+#include "graph-conversion.h"
+#include "shortest-paths.h"
+#include "spanning-trees.h"
+#include "error.h"
+using namespace std;
+
+/**
+ * Constant: kLightGray
+ * --------------------
+ * Defines an incredibly faint shade of gray.
+ */
+static const string kLightGray = "#eeeeee";
+
+// maps a list of edge indices back to the arcs they were built from
+static Vector<const arc *> toArcPath(const CompactGraph& cg, const vector<size_t>& edges) {
+    Vector<const arc *> path;
+    for (size_t e : edges) path += cg.arcs[e];
+    return path;
+}
+
+GraphAlgorithms::GraphAlgorithms(const graph& g) : cg(toCompactGraph(g)) {
+    vertices.reserve(cg.numVertices());
+    for (int v = 0; v < cg.numVertices(); v++) vertices[g.index.get(cg.names[v])] = v;
+}
+
+Vector<const arc *> GraphAlgorithms::findShortestPath(const node *start, const node *finish,
+                                                      GraphDisplay *display) const {
+    if (start == finish)
+        error("findShortestPath should only be called on two different endpoints.");
+
+    auto from = vertices.find(start), to = vertices.find(finish);
+    if (from == vertices.end() || to == vertices.end()) return Vector<const arc *>();
+    int source = from->second, target = to->second;
+
+    ShortestPathObserver observer;
+    if (display != nullptr) {
+        observer.settled = [&](const ShortestPathTree& tree, int v) {
+            if (v == tree.source || v == target) return;
+            Vector<const arc *> best = toArcPath(cg, pathEdgesTo(tree, v));
+            display->highlightPath(best, "Blue");
+            cout << "Exploring the partial path displayed in blue (cost: " << tree.dist[v] << ")" << endl;
+            display->highlightPath(best, kLightGray);
+        };
+    }
+
+    ShortestPathTree tree = computeShortestPaths(cg, source, target, display != nullptr ? &observer : nullptr);
+    return toArcPath(cg, pathEdgesTo(tree, target));
+}
+
+Vector<const arc *> GraphAlgorithms::generateMinimumSpanningTrees(GraphDisplay *display) const {
+    function<void(size_t)> edgeAdded;
+    if (display != nullptr) {
+        edgeAdded = [&](size_t e) {
+            cout << "Adding edge (cost: " << cg.costs[e] << ") to merge two forests." << endl;
+            display->updateArc(cg.arcs[e], "Blue", true);
+        };
+    }
+    SpanningForest forest = kruskalForest(cg, 0, edgeAdded);
+    return toArcPath(cg, forest.edges);
+}
+
+Vector<const arc *> findShortestPath(const graph& g, const node *start, const node *finish,
+                                     GraphDisplay *display) {
+    return GraphAlgorithms(g).findShortestPath(start, finish, display);
+}
+
+Vector<const arc *> generateMinimumSpanningTrees(const graph& g, GraphDisplay *display) {
+    return GraphAlgorithms(g).generateMinimumSpanningTrees(display);
+}
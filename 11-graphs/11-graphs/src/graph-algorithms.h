@@ -0,0 +1,67 @@
+/**
+ * File: graph-algorithms.h
+ * ------------------------
+ * Exports versions of the classic graph algorithms that work on the
+ * node/arc graph and can animate themselves in a GraphDisplay.  The
+ * searches themselves run over a CompactGraph, so leaving the display
+ * out gives the full speed of the underlying engines.
+ */
+
+#pragma once
+#include <unordered_map>
+#include "graphs.h"
+#include "compact-graph.h"
+#include "graph-display.h"
+#include "vector.h"
+
+/**
+ * Class: GraphAlgorithms
+ * ----------------------
+ * Holds g converted to a CompactGraph, along with the vertex number of
+ * each node, so that a session running many searches over the same graph
+ * converts it once rather than once per search.  g must outlive the
+ * object and keep its nodes and arcs while it is in use; after editing
+ * g, build a new one.
+ */
+class GraphAlgorithms {
+public:
+    GraphAlgorithms(const graph& g);
+
+    /**
+     * Method: findShortestPath
+     * ------------------------
+     * Follows Dijkstra's algorithm to determine the shortest path connecting
+     * start and finish.  If display is supplied, each partial path is
+     * flashed in blue as its endpoint is settled, just like the original demo.
+     */
+    Vector<const arc *> findShortestPath(const node *start, const node *finish,
+                                         GraphDisplay *display = nullptr) const;
+
+    /**
+     * Method: generateMinimumSpanningTrees
+     * ------------------------------------
+     * Implements Kruskal's algorithm to construct the minimal spanning forest
+     * and returns its arcs.  If display is supplied, each arc is colored
+     * blue as it merges two trees.
+     */
+    Vector<const arc *> generateMinimumSpanningTrees(GraphDisplay *display = nullptr) const;
+
+private:
+    CompactGraph cg;
+    std::unordered_map<const node *, int> vertices;
+};
+
+/**
+ * Function: findShortestPath
+ * --------------------------
+ * A one-off GraphAlgorithms(g).findShortestPath(start, finish, display).
+ */
+Vector<const arc *> findShortestPath(const graph& g, const node *start, const node *finish,
+                                     GraphDisplay *display = nullptr);
+
+/**
+ * Function: generateMinimumSpanningTrees
+ * --------------------------------------
+ * A one-off GraphAlgorithms(g).generateMinimumSpanningTrees(display).
+ */
+Vector<const arc *> generateMinimumSpanningTrees(const graph& g, GraphDisplay *display = nullptr);
@@ -0,0 +1,28 @@
+#include "graph-conversion.h"
+#include "vector.h"
+using namespace std;
+
+CompactGraph toCompactGraph(const graph& g) {
+    Vector<string> node_order = g.index.keys();
+    Map<const node *, int> nodeIndex;
+    for (int i = 0; i < node_order.size(); i++) {
+        nodeIndex.put(g.index.get(node_order[i]), i);
+    }
+
+    CompactGraph cg;
+    cg.offsets.push_back(0);
+    cg.targets.reserve(g.arcs.size());
+    cg.costs.reserve(g.arcs.size());
+    cg.arcs.reserve(g.arcs.size());
+    for (int i = 0; i < node_order.size(); i++) {
+        cg.names.push_back(node_order[i]);
+        for (const arc *a : g.index.get(node_order[i])->arcs) {
+            cg.targets.push_back(nodeIndex.get(a->to));
+            cg.costs.push_back(a->cost);
+            cg.arcs.push_back(a);
+        }
+        cg.offsets.push_back(cg.targets.size());
+    }
+    sortAdjacencyLists(cg);
+    return cg;
+}
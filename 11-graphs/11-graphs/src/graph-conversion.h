@@ -0,0 +1,19 @@
+/**
+ * File: graph-conversion.h
+ * ------------------------
+ * Bridges the node/arc graph in graphs.h and the CompactGraph used by
+ * the heavier analyses.
+ */
+
+#pragma once
+#include "graphs.h"
+#include "compact-graph.h"
+
+/**
+ * Function: toCompactGraph
+ * ------------------------
+ * Numbers the nodes of g in the order of g.index.keys() (the same order
+ * makeMarkov and getRank use) and returns the matching CompactGraph, with
+ * arc costs as edge costs and each edge remembering its arc.
+ */
+CompactGraph toCompactGraph(const graph& g);
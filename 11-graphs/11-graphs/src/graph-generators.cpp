@@ -0,0 +1,336 @@
+#include "graph-generators.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <string>
+#include "engine-error.h"
+#include "parallel.h"
+using namespace std;
+
+// edges generated per block by R-MAT and Barabasi-Albert
+static const long long kBlockEdges = 1 << 16;
+
+// source vertices per block for Erdos-Renyi
+static const int kBlockVertices = 1024;
+
+// chunk size for splitting vertex loops across threads
+static const int kGrain = 2048;
+
+// splitmix64's finalizer: spreads any change in x over all the bits
+static inline unsigned long long mix(unsigned long long x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// xorshift64* seeded from the graph's seed and a block index
+class BlockRandom {
+public:
+    BlockRandom(unsigned long long seed, unsigned long long block) : state(mix(seed ^ mix(block)) | 1) {}
+
+    unsigned long long next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545f4914f6cdd1dULL;
+    }
+
+    // uniform in [0, 1)
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+    unsigned long long state;
+};
+
+// fills edges with the edges of one block; must depend only on the block index
+typedef function<void(int block, vector<WeightedEdge>& edges)> BlockGenerator;
+
+static int numBlocks(long long count, long long perBlock) {
+    return (int) ((count + perBlock - 1) / perBlock);
+}
+
+static void streamBlocks(int blocks, const BlockGenerator& generate, int numThreads, const EdgeSink& sink) {
+    numThreads = resolveThreadCount(numThreads);
+    vector<vector<WeightedEdge>> buffers(numThreads);
+    parallelFor(0, blocks, 1, [&](int t, int lo, int hi) {
+        for (int block = lo; block < hi; block++) {
+            buffers[t].clear();
+            generate(block, buffers[t]);
+            sink(buffers[t]);
+        }
+    }, numThreads);
+}
+
+// counts the out-degrees in one pass over the blocks, then regenerates them to place each link
+static CompactGraph buildFromBlocks(int n, int blocks, const BlockGenerator& generate, int numThreads) {
+    unique_ptr<atomic<size_t>[]> cursor(new atomic<size_t>[n]);
+    for (int v = 0; v < n; v++) cursor[v].store(0, memory_order_relaxed);
+    streamBlocks(blocks, generate, numThreads, [&](const vector<WeightedEdge>& edges) {
+        for (const WeightedEdge& e : edges) cursor[e.from].fetch_add(1, memory_order_relaxed);
+    });
+
+    CompactGraph g;
+    g.offsets.assign(n + 1, 0);
+    for (int v = 0; v < n; v++) {
+        g.offsets[v + 1] = g.offsets[v] + cursor[v].load(memory_order_relaxed);
+        cursor[v].store(g.offsets[v], memory_order_relaxed);
+    }
+    g.targets.resize(g.offsets[n]);
+    g.costs.assign(g.offsets[n], 1);
+    g.names.resize(n);
+    streamBlocks(blocks, generate, numThreads, [&](const vector<WeightedEdge>& edges) {
+        for (const WeightedEdge& e : edges) g.targets[cursor[e.from].fetch_add(1, memory_order_relaxed)] = e.to;
+    });
+
+    // links land in whatever order the threads reach them, so sorting each list makes the graph reproducible
+    parallelFor(0, n, kGrain, [&](int, int lo, int hi) {
+        for (int v = lo; v < hi; v++) sort(g.targets.begin() + g.offsets[v], g.targets.begin() + g.offsets[v + 1]);
+    }, numThreads);
+    return g;
+}
+
+// a fixed bijection of [0, 2^scale), so R-MAT's heavy vertices are spread out
+static inline unsigned long long scramble(unsigned long long v, int scale, unsigned long long seed) {
+    unsigned long long mask = (1ULL << scale) - 1;
+    v = (v * 0x9e3779b97f4a7c15ULL) & mask;
+    v ^= v >> (scale / 2 + 1);
+    v = (v * 0xbf58476d1ce4e5b9ULL) & mask;
+    return v ^ (mix(seed) & mask);
+}
+
+static BlockGenerator rmatBlocks(int scale, long long numEdges, const RmatParameters& parameters,
+                                 unsigned long long seed) {
+    // each level draws 32 random bits, compared against the quadrant boundaries
+    const double kLevelRange = 4294967296.0;
+    unsigned long long a = parameters.a * kLevelRange;
+    unsigned long long ab = (parameters.a + parameters.b) * kLevelRange;
+    unsigned long long abc = (parameters.a + parameters.b + parameters.c) * kLevelRange;
+    return [=](int block, vector<WeightedEdge>& edges) {
+        BlockRandom random(seed, block);
+        long long first = block * kBlockEdges, last = min(numEdges, first + kBlockEdges);
+        for (long long e = first; e < last; e++) {
+            unsigned long long from = 0, to = 0, bits = 0;
+            for (int level = 0; level < scale; level++) {
+                if (level % 2 == 0) bits = random.next();
+                unsigned long long r = bits & 0xffffffffULL;
+                bits >>= 32;
+                // the quadrants are [0, a), [a, ab), [ab, abc) and [abc, 1): without branches,
+                // which would be mispredicted about half the time
+                from = (from << 1) | (r >= ab);
+                to = (to << 1) | ((r >= a) ^ (r >= ab) ^ (r >= abc));
+            }
+            edges.push_back({(int) scramble(from, scale, seed), (int) scramble(to, scale, seed), 1});
+        }
+    };
+}
+
+static void checkRmat(int scale, long long numEdges, const RmatParameters& parameters) {
+    if (scale < 0 || scale > 30) error("rmatGraph: scale must be between 0 and 30");
+    if (numEdges < 0) error("rmatGraph: numEdges must not be negative");
+    if (parameters.a < 0 || parameters.b < 0 || parameters.c < 0 || parameters.a + parameters.b + parameters.c > 1) {
+        error("rmatGraph: the quadrant probabilities must be nonnegative and sum to at most 1");
+    }
+}
+
+void generateRmatEdges(int scale, long long numEdges, const RmatParameters& parameters,
+                       const GeneratorOptions& options, const EdgeSink& sink) {
+    checkRmat(scale, numEdges, parameters);
+    streamBlocks(numBlocks(numEdges, kBlockEdges), rmatBlocks(scale, numEdges, parameters, options.seed),
+                 options.numThreads, sink);
+}
+
+CompactGraph rmatGraph(int scale, long long numEdges, const RmatParameters& parameters,
+                       const GeneratorOptions& options) {
+    checkRmat(scale, numEdges, parameters);
+    return buildFromBlocks(1 << scale, numBlocks(numEdges, kBlockEdges),
+                           rmatBlocks(scale, numEdges, parameters, options.seed), options.numThreads);
+}
+
+// Edge e leaves vertex 1 + e / edgesPerVertex.  Listing every edge's source
+// and then target, entry 2e is edge e's source and entry 2e + 1 its target;
+// the target copies an entry chosen uniformly from the 2e before it, which
+// is a vertex with probability proportional to its degree so far.
+static BlockGenerator barabasiAlbertBlocks(int n, int edgesPerVertex, unsigned long long seed) {
+    long long numEdges = (long long) max(0, n - 1) * edgesPerVertex;
+    return [=](int block, vector<WeightedEdge>& edges) {
+        long long first = block * kBlockEdges, last = min(numEdges, first + kBlockEdges);
+        for (long long e = first; e < last; e++) {
+            // a copied target is resolved the same way, until a copy lands on a source
+            long long copied = e;
+            int target = 0;
+            while (copied > 0) {
+                long long entry = (long long) (mix(seed ^ mix(copied)) % (unsigned long long) (2 * copied));
+                if (entry % 2 == 0) {
+                    target = (int) (1 + entry / 2 / edgesPerVertex);
+                    break;
+                }
+                copied = entry / 2;
+            }
+            edges.push_back({(int) (1 + e / edgesPerVertex), target, 1});
+        }
+    };
+}
+
+static void checkBarabasiAlbert(int n, int edgesPerVertex) {
+    if (n < 0 || edgesPerVertex < 0) error("barabasiAlbertGraph: n and edgesPerVertex must not be negative");
+}
+
+void generateBarabasiAlbertEdges(int n, int edgesPerVertex, const GeneratorOptions& options,
+                                 const EdgeSink& sink) {
+    checkBarabasiAlbert(n, edgesPerVertex);
+    long long numEdges = (long long) max(0, n - 1) * edgesPerVertex;
+    streamBlocks(numBlocks(numEdges, kBlockEdges), barabasiAlbertBlocks(n, edgesPerVertex, options.seed),
+                 options.numThreads, sink);
+}
+
+CompactGraph barabasiAlbertGraph(int n, int edgesPerVertex, const GeneratorOptions& options) {
+    checkBarabasiAlbert(n, edgesPerVertex);
+    long long numEdges = (long long) max(0, n - 1) * edgesPerVertex;
+    return buildFromBlocks(n, numBlocks(numEdges, kBlockEdges), barabasiAlbertBlocks(n, edgesPerVertex, options.seed),
+                           options.numThreads);
+}
+
+static BlockGenerator erdosRenyiBlocks(int n, double p, unsigned long long seed) {
+    return [=](int block, vector<WeightedEdge>& edges) {
+        BlockRandom random(seed, block);
+        int first = block * kBlockVertices, last = min(n, first + kBlockVertices);
+        double logMiss = log1p(-p);
+        for (int v = first; v < last; v++) {
+            // k walks the n - 1 possible targets (every vertex but v)
+            long long k = -1;
+            while (true) {
+                double skip = p >= 1 ? 0 : floor(log1p(-random.uniform()) / logMiss);
+                if (k + 1 + skip >= n - 1) break;
+                k += 1 + (long long) skip;
+                edges.push_back({v, (int) (k < v ? k : k + 1), 1});
+            }
+        }
+    };
+}
+
+static void checkErdosRenyi(int n, double p) {
+    if (n < 0) error("erdosRenyiGraph: n must not be negative");
+    if (!(p >= 0 && p <= 1)) error("erdosRenyiGraph: p must be between 0 and 1");
+}
+
+void generateErdosRenyiEdges(int n, double p, const GeneratorOptions& options, const EdgeSink& sink) {
+    checkErdosRenyi(n, p);
+    if (p == 0) return;
+    streamBlocks(numBlocks(n, kBlockVertices), erdosRenyiBlocks(n, p, options.seed), options.numThreads, sink);
+}
+
+CompactGraph erdosRenyiGraph(int n, double p, const GeneratorOptions& options) {
+    checkErdosRenyi(n, p);
+    return buildFromBlocks(n, p == 0 ? 0 : numBlocks(n, kBlockVertices), erdosRenyiBlocks(n, p, options.seed),
+                           options.numThreads);
+}
+
+// the window area that geometric vertices are scattered over
+static const double kGeometricWidth = kWindowWidth - 2 * kInset;
+static const double kGeometricHeight = kWindowHeight - 2 * kInset;
+
+// keeps a geometric graph's coin tosses apart from the draws that place its vertices
+static const unsigned long long kPairSalt = 0x5851f42d4c957f2dULL;
+
+double geometricRange(int n, double averageDegree) {
+    if (n < 2 || averageDegree <= 0) error("geometricRange: need two vertices and a positive degree");
+    // away from the edges, a vertex expects (n - 1) / area * integral of 2 pi d (1 - d / range)^6
+    // over [0, range], which is (n - 1) pi range^2 / (28 area) neighbours
+    const double kPi = 3.14159265358979323846;
+    return sqrt(28 * kGeometricWidth * kGeometricHeight * averageDegree / (kPi * (n - 1)));
+}
+
+// uniform in [0, 1), the same whichever of u and v asks
+static inline double pairCoin(unsigned long long seed, int u, int v) {
+    unsigned long long low = min(u, v), high = max(u, v);
+    return (mix(seed ^ kPairSalt ^ mix(low << 32 | high)) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+CompactGraph geometricGraph(int n, const GeometricOptions& geometry, const GeneratorOptions& options,
+                            vector<GeometricPoint> *positions) {
+    if (n < 0) error("geometricGraph: n must not be negative");
+    if (!(geometry.range > 0)) error("geometricGraph: range must be positive");
+    if (!(geometry.minProbability >= 0 && geometry.minProbability <= 1)) {
+        error("geometricGraph: minProbability must be between 0 and 1");
+    }
+    int numThreads = resolveThreadCount(options.numThreads);
+    vector<GeometricPoint> scattered(n);
+    parallelFor(0, n, kGrain, [&](int, int lo, int hi) {
+        for (int v = lo; v < hi; v++) {
+            BlockRandom random(options.seed, v);
+            scattered[v].x = kInset + random.uniform() * kGeometricWidth;
+            scattered[v].y = kInset + random.uniform() * kGeometricHeight;
+        }
+    }, numThreads);
+
+    // cells at least as wide as the radius, but no more of them than vertices
+    double radius = geometry.range * (1 - pow(geometry.minProbability, 1.0 / 6));
+    double cellSize = max(radius, sqrt(kGeometricWidth * kGeometricHeight / max(1, n)));
+    int columns = max(1, (int) ceil(kGeometricWidth / cellSize));
+    int rows = max(1, (int) ceil(kGeometricHeight / cellSize));
+    auto cellOf = [&](const GeometricPoint& p) {
+        int column = min(columns - 1, (int) ((p.x - kInset) / cellSize));
+        int row = min(rows - 1, (int) ((p.y - kInset) / cellSize));
+        return row * columns + column;
+    };
+
+    // vertices are numbered cell by cell (a counting sort, which keeps the
+    // draw order within a cell), so a cell's vertices sit together in memory
+    // and the neighbour search mostly hits the cache
+    vector<int> cellStart(columns * rows + 1, 0), cells(n);
+    for (int v = 0; v < n; v++) {
+        cells[v] = cellOf(scattered[v]);
+        cellStart[cells[v] + 1]++;
+    }
+    for (int c = 0; c < columns * rows; c++) cellStart[c + 1] += cellStart[c];
+    vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    vector<GeometricPoint> points(n);
+    for (int v = 0; v < n; v++) points[fill[cells[v]]++] = scattered[v];
+
+    // each chunk of vertices collects its own links, which are then copied into place
+    int numChunks = numBlocks(n, kGrain);
+    vector<vector<pair<int, double>>> chunkLinks(numChunks);
+    vector<size_t> degrees(n);
+    double radiusSquared = radius * radius;
+    parallelFor(0, n, kGrain, [&](int, int lo, int hi) {
+        vector<pair<int, double>>& links = chunkLinks[lo / kGrain];
+        for (int u = lo; u < hi; u++) {
+            size_t first = links.size();
+            int cell = cellOf(points[u]), column = cell % columns, row = cell / columns;
+            for (int r = max(0, row - 1); r <= min(rows - 1, row + 1); r++) {
+                // the neighbouring cells in a row hold consecutive vertices
+                int from = cellStart[r * columns + max(0, column - 1)];
+                int to = cellStart[r * columns + min(columns - 1, column + 1) + 1];
+                for (int v = from; v < to; v++) {
+                    double dx = points[u].x - points[v].x, dy = points[u].y - points[v].y;
+                    double squared = dx * dx + dy * dy;
+                    if (v == u || squared >= radiusSquared) continue;
+                    double distance = sqrt(squared);
+                    double closeness = 1 - distance / geometry.range;
+                    closeness *= closeness * closeness;
+                    if (pairCoin(options.seed, u, v) < closeness * closeness) links.push_back(make_pair(v, distance));
+                }
+            }
+            degrees[u] = links.size() - first;
+        }
+    }, numThreads);
+
+    CompactGraph g;
+    g.offsets.assign(n + 1, 0);
+    for (int v = 0; v < n; v++) g.offsets[v + 1] = g.offsets[v] + degrees[v];
+    g.targets.resize(g.offsets[n]);
+    g.costs.resize(g.offsets[n]);
+    g.names.resize(n);
+    parallelFor(0, n, kGrain, [&](int, int lo, int hi) {
+        const vector<pair<int, double>>& links = chunkLinks[lo / kGrain];
+        for (size_t i = 0; i < links.size(); i++) {
+            g.targets[g.offsets[lo] + i] = links[i].first;
+            g.costs[g.offsets[lo] + i] = links[i].second;
+        }
+        for (int v = lo; v < hi; v++) g.names[v] = to_string(v);
+    }, numThreads);
+    if (positions != nullptr) positions->swap(points);
+    return g;
+}
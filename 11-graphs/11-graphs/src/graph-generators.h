@@ -0,0 +1,148 @@
+/**
+ * File: graph-generators.h
+ * ------------------------
+ * Exports generators for large synthetic graphs, for load testing and
+ * benchmarking without scraping anything:
+ *
+ *   - R-MAT (a recursive Kronecker model), which has the skewed degrees
+ *     and community structure of web and citation graphs,
+ *   - Barabasi-Albert preferential attachment, whose in-degrees follow a
+ *     power law, and
+ *   - Erdos-Renyi G(n, p), where every possible link appears on its own
+ *     with probability p, and
+ *   - random geometric graphs, laid out in the graphics window and linked
+ *     by distance the way buildRandomGraph links its nodes, for testing
+ *     shortest paths and spanning trees on graphs far too big to draw.
+ *
+ * Every generator splits its output into fixed blocks and seeds each block
+ * from the seed and its index alone, so the same seed gives the same graph
+ * whatever the number of threads.  Each comes in two forms: one streams the
+ * edges a block at a time to a sink, for feeding them straight into some
+ * other ingestion step, and one builds the CompactGraph directly.  The
+ * latter runs the generator twice (once to count degrees, once to fill in
+ * the links) rather than buffering a list of edges, so it needs no memory
+ * beyond the graph itself and scales to billions of edges.
+ */
+
+#pragma once
+#include <functional>
+#include <vector>
+#include "compact-graph.h"
+#include "graph-constants.h"
+
+/**
+ * Type: GeneratorOptions
+ * ----------------------
+ * seed selects the graph; numThreads of 0 uses every hardware thread.
+ */
+struct GeneratorOptions {
+    unsigned long long seed = 1;
+    int numThreads = 0;
+};
+
+/**
+ * Type: EdgeSink
+ * --------------
+ * Receives one block of generated edges (all of cost 1).  Blocks are
+ * generated in parallel, so a sink may be called from several threads at
+ * once and sees the blocks in no particular order.
+ */
+typedef std::function<void(const std::vector<WeightedEdge>& block)> EdgeSink;
+
+/**
+ * Type: RmatParameters
+ * --------------------
+ * The chances that an edge falls in the top-left, top-right and bottom-left
+ * quarter of the adjacency matrix at each level of the recursion (the
+ * bottom-right gets the rest).  The defaults are Graph500's.
+ */
+struct RmatParameters {
+    double a = 0.57;
+    double b = 0.19;
+    double c = 0.19;
+};
+
+/**
+ * Function: generateRmatEdges, rmatGraph
+ * --------------------------------------
+ * Generates numEdges edges over 2^scale vertices.  Vertex ids are shuffled
+ * by a fixed bijection so that the heavy vertices are not all clustered at
+ * low ids.  Repeated edges and self-loops are kept, as in Graph500.
+ */
+void generateRmatEdges(int scale, long long numEdges, const RmatParameters& parameters,
+                       const GeneratorOptions& options, const EdgeSink& sink);
+CompactGraph rmatGraph(int scale, long long numEdges, const RmatParameters& parameters = RmatParameters(),
+                       const GeneratorOptions& options = GeneratorOptions());
+
+/**
+ * Function: generateBarabasiAlbertEdges, barabasiAlbertGraph
+ * ----------------------------------------------------------
+ * Grows a graph of n vertices in which each vertex after the first links
+ * to edgesPerVertex earlier vertices, each picked with probability
+ * proportional to its degree so far.  This follows the parallel version of
+ * the model by Sanders and Schulz: listing the endpoints of all edges in
+ * order, an edge's target is a copy of a uniformly random earlier entry,
+ * and since that choice depends only on the edge's index, every edge can
+ * be produced independently by following copies back to a source.  Like
+ * the original model it may repeat edges and make self-loops.
+ */
+void generateBarabasiAlbertEdges(int n, int edgesPerVertex, const GeneratorOptions& options,
+                                 const EdgeSink& sink);
+CompactGraph barabasiAlbertGraph(int n, int edgesPerVertex, const GeneratorOptions& options = GeneratorOptions());
+
+/**
+ * Function: generateErdosRenyiEdges, erdosRenyiGraph
+ * --------------------------------------------------
+ * Includes each of the n(n - 1) possible links (no self-loops) with
+ * probability p, independently.  Rather than tossing a coin per pair, it
+ * jumps straight to the next included link with a geometric skip, so the
+ * cost is proportional to the edges produced.
+ */
+void generateErdosRenyiEdges(int n, double p, const GeneratorOptions& options, const EdgeSink& sink);
+CompactGraph erdosRenyiGraph(int n, double p, const GeneratorOptions& options = GeneratorOptions());
+
+/**
+ * Type: GeometricOptions, GeometricPoint
+ * --------------------------------------
+ * A geometric graph scatters its vertices uniformly over the window (kInset
+ * in from each side, as buildRandomGraph does) and links two vertices at
+ * distance d with probability (1 - d / range)^6.  The default range of
+ * kMaxDistance is buildRandomGraph's rule; since that links every vertex to
+ * a good fraction of the others, bigger graphs want a smaller range (see
+ * geometricRange).  Pairs whose chance is below minProbability are never
+ * considered, which shrinks the search radius to
+ * range * (1 - minProbability^(1/6)).
+ */
+struct GeometricOptions {
+    double range = kMaxDistance;
+    double minProbability = 0;
+};
+
+struct GeometricPoint {
+    double x, y;
+};
+
+/**
+ * Function: geometricRange
+ * ------------------------
+ * Returns the range that gives n scattered vertices about averageDegree
+ * neighbours each (a little fewer near the edges of the window).
+ */
+double geometricRange(int n, double averageDegree);
+
+/**
+ * Function: geometricGraph
+ * ------------------------
+ * Builds a geometric graph over n vertices named "0" through "n - 1".
+ * Every link goes both ways and costs the distance between its endpoints.
+ * Vertices are bucketed into a grid of cells as wide as the search radius,
+ * so each is only compared with the vertices in its own and the eight
+ * surrounding cells, rather than with every other vertex; vertices are
+ * handled in parallel.  They are numbered cell by cell, so nearby vertices
+ * have nearby ids.  Each pair's coin toss is seeded by the pair itself, so
+ * the graph does not depend on the number of threads.  If positions is not
+ * null, it receives each vertex's location.
+ */
+CompactGraph geometricGraph(int n, const GeometricOptions& geometry = GeometricOptions(),
+                            const GeneratorOptions& options = GeneratorOptions(),
+                            std::vector<GeometricPoint> *positions = nullptr);
@@ -0,0 +1,153 @@
+#include "hardware-counters.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+double HardwareCounts::ipc() const {
+    if (cycles <= 0 || instructions < 0) return -1;
+    return (double) instructions / cycles;
+}
+
+HardwareCounts& HardwareCounts::operator+=(const HardwareCounts& other) {
+    long long HardwareCounts::*counts[] = {
+        &HardwareCounts::cycles, &HardwareCounts::instructions,
+        &HardwareCounts::cacheMisses, &HardwareCounts::branchMisses
+    };
+    for (long long HardwareCounts::*count : counts) {
+        this->*count = (this->*count < 0 || other.*count < 0) ? -1 : this->*count + other.*count;
+    }
+    return *this;
+}
+
+#ifdef __linux__
+
+// in the order of fds
+static const unsigned long long kEventConfigs[] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+};
+static const char *const kEventNames[] = {"cycles", "instructions", "cache misses", "branch misses"};
+
+static string openFailure(int code) {
+    switch (code) {
+    case ENOENT:
+    case EOPNOTSUPP:
+        return "not exposed by this CPU (or the virtual machine it runs in)";
+    case EACCES:
+    case EPERM:
+        return "not permitted; lowering /proc/sys/kernel/perf_event_paranoid may help";
+    case ENOSYS:
+        return "this kernel does not support perf_event_open";
+    default:
+        return strerror(code);
+    }
+}
+
+HardwareCounters::HardwareCounters() {
+    // the events that failed for each reason, so the usual case of all of
+    // them failing for one reason reads as a single sentence
+    vector<pair<string, string>> failures;
+    for (int i = 0; i < kNumEvents; i++) {
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = kEventConfigs[i];
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // user space only, which is all an unprivileged process may count
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        // counts from threads started later are folded in when they exit
+        attributes.inherit = 1;
+        fds[i] = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+        if (fds[i] < 0) {
+            string why = openFailure(errno);
+            auto same = find_if(failures.begin(), failures.end(),
+                                [&why](const pair<string, string>& failure) { return failure.first == why; });
+            if (same == failures.end()) {
+                failures.push_back(make_pair(why, kEventNames[i]));
+            } else {
+                same->second += string(", ") + kEventNames[i];
+            }
+        }
+        started[i] = {0, 0, 0};
+    }
+    for (const pair<string, string>& failure : failures) {
+        if (!reason.empty()) reason += "; ";
+        reason += failure.second + ": " + failure.first;
+    }
+}
+
+HardwareCounters::~HardwareCounters() {
+    for (int fd : fds) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+bool HardwareCounters::read(int i, Reading& reading) const {
+    if (fds[i] < 0) return false;
+    unsigned long long values[3];
+    if (::read(fds[i], values, sizeof(values)) != (ssize_t) sizeof(values)) return false;
+    reading = {(long long) values[0], (long long) values[1], (long long) values[2]};
+    return true;
+}
+
+#else
+
+HardwareCounters::HardwareCounters() : reason("hardware counters need Linux's perf_event_open") {
+    for (int i = 0; i < kNumEvents; i++) {
+        fds[i] = -1;
+        started[i] = {0, 0, 0};
+    }
+}
+
+HardwareCounters::~HardwareCounters() {}
+
+bool HardwareCounters::read(int, Reading&) const {
+    return false;
+}
+
+#endif
+
+bool HardwareCounters::available() const {
+    for (int fd : fds) {
+        if (fd >= 0) return true;
+    }
+    return false;
+}
+
+// the counters run all along (resetting them would not clear what exited
+// threads have handed back), so start and stop take differences
+void HardwareCounters::start() {
+    for (int i = 0; i < kNumEvents; i++) {
+        if (!read(i, started[i])) started[i] = {0, 0, 0};
+    }
+}
+
+HardwareCounts HardwareCounters::stop() {
+    long long results[kNumEvents];
+    for (int i = 0; i < kNumEvents; i++) {
+        Reading now;
+        results[i] = -1;
+        if (!read(i, now)) continue;
+        long long value = now.value - started[i].value;
+        long long enabled = now.enabled - started[i].enabled;
+        long long running = now.running - started[i].running;
+        if (running > 0 && running < enabled) value = (long long) ((double) value * enabled / running);
+        // a counter that never got a turn on the hardware measured nothing
+        if (running > 0 || enabled == 0) results[i] = value;
+    }
+    HardwareCounts counts;
+    counts.cycles = results[0];
+    counts.instructions = results[1];
+    counts.cacheMisses = results[2];
+    counts.branchMisses = results[3];
+    return counts;
+}
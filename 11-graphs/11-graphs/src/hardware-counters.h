@@ -0,0 +1,88 @@
+/**
+ * File: hardware-counters.h
+ * -------------------------
+ * Exports a thin wrapper around the CPU's performance counters (through
+ * Linux's perf_event_open), for telling whether a phase like the power
+ * iteration is held up by memory bandwidth, by cache-miss latency or by
+ * mispredicted branches.  Iteration times alone cannot say which.
+ *
+ * Counters are often missing: other operating systems, virtual machines
+ * that hide them, and kernels whose perf_event_paranoid setting forbids
+ * them.  The wrapper then reports the counts it could not get as unknown
+ * and says why, rather than failing, so callers can print what they have.
+ */
+
+#pragma once
+#include <string>
+
+/**
+ * Type: HardwareCounts
+ * --------------------
+ * Counts over some stretch of a run, summed over the calling thread and
+ * every thread it started meanwhile.  cacheMisses counts misses in the
+ * last-level cache (the kernel's generic cache-miss event, which is what
+ * it maps to on current x86 and ARM parts).  A count of -1 is unknown.
+ */
+struct HardwareCounts {
+    long long cycles = -1;
+    long long instructions = -1;
+    long long cacheMisses = -1;
+    long long branchMisses = -1;
+
+    /**
+     * Method: ipc
+     * -----------
+     * Returns instructions per cycle, or -1 if either is unknown.
+     */
+    double ipc() const;
+
+    /**
+     * Operator: +=
+     * ------------
+     * Adds other's counts into these; a count unknown in either stays unknown.
+     */
+    HardwareCounts& operator+=(const HardwareCounts& other);
+};
+
+/**
+ * Class: HardwareCounters
+ * -----------------------
+ * Opens the counters for the calling thread and the threads it starts
+ * from then on (so work handed to parallelFor is counted too), and
+ * measures whatever runs between start and stop.  If the kernel had to
+ * share the counters among more events than it has registers for, the
+ * counts are scaled up from the time each was actually counting.
+ */
+class HardwareCounters {
+public:
+    HardwareCounters();
+    ~HardwareCounters();
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    /**
+     * Method: available, problem
+     * --------------------------
+     * available is true if at least one counter opened.  problem explains
+     * why any did not (and is empty if all did).
+     */
+    bool available() const;
+    const std::string& problem() const { return reason; }
+
+    /**
+     * Method: start, stop
+     * -------------------
+     * stop returns the counts since the last start.
+     */
+    void start();
+    HardwareCounts stop();
+
+private:
+    static const int kNumEvents = 4;
+    struct Reading { long long value, enabled, running; };
+    bool read(int i, Reading& reading) const;
+
+    int fds[kNumEvents];
+    Reading started[kNumEvents];
+    std::string reason;
+};
@@ -0,0 +1,223 @@
+#include "instrumentation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+using namespace std;
+
+// the events one thread has recorded since the last flush
+struct ThreadLog {
+    mutex lock;
+    vector<InstrumentEvent> events;
+    int thread;
+};
+
+struct CounterSlot {
+    const char *name;
+    atomic<long long> total;
+};
+
+// the thread logs and counters, which outlive the threads that use them
+static mutex registryLock;
+static vector<shared_ptr<ThreadLog>> threadLogs;
+static deque<CounterSlot> counters;
+
+long long instrumentNow() {
+    static const chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+static ThreadLog& threadLog() {
+    thread_local shared_ptr<ThreadLog> log;
+    if (!log) {
+        log = make_shared<ThreadLog>();
+        lock_guard<mutex> guard(registryLock);
+        log->thread = threadLogs.size();
+        threadLogs.push_back(log);
+    }
+    return *log;
+}
+
+static void record(const InstrumentEvent& event) {
+    ThreadLog& log = threadLog();
+    // only a flush ever competes for this lock
+    lock_guard<mutex> guard(log.lock);
+    log.events.push_back(event);
+    log.events.back().thread = log.thread;
+}
+
+void recordSpan(const char *name, long long start, long long end) {
+    record({InstrumentEvent::Span, name, start, end - start, 0, 0});
+}
+
+void recordSample(const char *name, double value) {
+    record({InstrumentEvent::Sample, name, instrumentNow(), 0, value, 0});
+}
+
+atomic<long long>& instrumentCounter(const char *name) {
+    lock_guard<mutex> guard(registryLock);
+    for (CounterSlot& slot : counters) {
+        if (strcmp(slot.name, name) == 0) return slot.total;
+    }
+    counters.emplace_back();
+    counters.back().name = name;
+    counters.back().total.store(0);
+    return counters.back().total;
+}
+
+void flushInstrumentation(const InstrumentSink& sink) {
+    InstrumentReport report;
+    {
+        lock_guard<mutex> guard(registryLock);
+        for (const shared_ptr<ThreadLog>& log : threadLogs) {
+            lock_guard<mutex> logGuard(log->lock);
+            report.events.insert(report.events.end(), log->events.begin(), log->events.end());
+            log->events.clear();
+        }
+        for (CounterSlot& slot : counters) report.counters.push_back(make_pair(string(slot.name), slot.total.exchange(0)));
+    }
+    stable_sort(report.events.begin(), report.events.end(),
+                [](const InstrumentEvent& a, const InstrumentEvent& b) { return a.start < b.start; });
+    sink(report);
+}
+
+void writeInstrumentSummary(const InstrumentReport& report, ostream& out) {
+    struct SpanTotals { long long calls = 0, total = 0, longest = 0; };
+    struct SampleTotals { long long count = 0; double first = 0, last = 0, least = 0, greatest = 0; };
+    // in order of first appearance, which is roughly the order of the run
+    vector<const char *> spanOrder, sampleOrder;
+    map<string, SpanTotals> spans;
+    map<string, SampleTotals> samples;
+    for (const InstrumentEvent& event : report.events) {
+        if (event.kind == InstrumentEvent::Span) {
+            SpanTotals& totals = spans[event.name];
+            if (totals.calls++ == 0) spanOrder.push_back(event.name);
+            totals.total += event.duration;
+            totals.longest = max(totals.longest, event.duration);
+        } else {
+            SampleTotals& totals = samples[event.name];
+            if (totals.count++ == 0) {
+                sampleOrder.push_back(event.name);
+                totals.first = totals.least = totals.greatest = event.value;
+            }
+            totals.last = event.value;
+            totals.least = min(totals.least, event.value);
+            totals.greatest = max(totals.greatest, event.value);
+        }
+    }
+
+    // columns are lined up with the stream's own manipulators, which are put back afterwards
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+    if (!spanOrder.empty()) {
+        out << left << setw(32) << "span" << right << " " << setw(10) << "calls" << " " << setw(14) << "total ms"
+            << " " << setw(14) << "mean us" << " " << setw(14) << "longest us" << endl;
+        out << fixed << setprecision(3);
+        for (const char *name : spanOrder) {
+            const SpanTotals& totals = spans[name];
+            out << left << setw(32) << name << right << " " << setw(10) << totals.calls << " " << setw(14)
+                << totals.total / 1e6 << " " << setw(14) << totals.total / 1e3 / totals.calls << " " << setw(14)
+                << totals.longest / 1e3 << endl;
+        }
+    }
+    if (!report.counters.empty()) {
+        out << left << setw(32) << "counter" << right << " " << setw(14) << "total" << endl;
+        for (const pair<string, long long>& counter : report.counters) {
+            out << left << setw(32) << counter.first << right << " " << setw(14) << counter.second << endl;
+        }
+    }
+    if (!sampleOrder.empty()) {
+        out << left << setw(32) << "sample" << right << " " << setw(10) << "count";
+        for (const char *heading : {"first", "last", "least", "greatest"}) out << " " << setw(12) << heading;
+        out << endl;
+        out.unsetf(ios::floatfield);
+        out << setprecision(6);
+        for (const char *name : sampleOrder) {
+            const SampleTotals& totals = samples[name];
+            out << left << setw(32) << name << right << " " << setw(10) << totals.count;
+            for (double value : {totals.first, totals.last, totals.least, totals.greatest}) {
+                out << " " << setw(12) << value;
+            }
+            out << endl;
+        }
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// quotes text as a JSON string
+static string jsonString(const string& text) {
+    string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if ((unsigned char) c < 0x20) {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", (int) c);
+            quoted += escape;
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+// JSON has no NaN or infinity
+static string jsonNumber(double value) {
+    if (value != value || value - value != 0) return "null";
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.17g", value);
+    return buffer;
+}
+
+// nanoseconds as the microseconds a trace expects, to the nanosecond
+static string traceTime(long long nanoseconds) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.3f", nanoseconds / 1e3);
+    return buffer;
+}
+
+void writeInstrumentJsonLines(const InstrumentReport& report, ostream& out) {
+    for (const InstrumentEvent& event : report.events) {
+        if (event.kind == InstrumentEvent::Span) {
+            out << "{\"type\":\"span\",\"name\":" << jsonString(event.name) << ",\"thread\":" << event.thread
+                << ",\"start_ns\":" << event.start << ",\"duration_ns\":" << event.duration << "}\n";
+        } else {
+            out << "{\"type\":\"sample\",\"name\":" << jsonString(event.name) << ",\"thread\":" << event.thread
+                << ",\"time_ns\":" << event.start << ",\"value\":" << jsonNumber(event.value) << "}\n";
+        }
+    }
+    for (const pair<string, long long>& counter : report.counters) {
+        out << "{\"type\":\"counter\",\"name\":" << jsonString(counter.first) << ",\"total\":" << counter.second
+            << "}\n";
+    }
+    out.flush();
+}
+
+void writeChromeTrace(const InstrumentReport& report, ostream& out) {
+    // trace times are in microseconds, so nanoseconds become three decimals
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const InstrumentEvent& event : report.events) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":" << jsonString(event.name) << ",\"pid\":1,\"tid\":" << event.thread
+            << ",\"ts\":" << traceTime(event.start);
+        if (event.kind == InstrumentEvent::Span) {
+            out << ",\"ph\":\"X\",\"dur\":" << traceTime(event.duration) << "}";
+        } else {
+            out << ",\"ph\":\"C\",\"args\":{\"value\":" << jsonNumber(event.value) << "}}";
+        }
+    }
+    out << "\n],\"otherData\":{";
+    for (size_t i = 0; i < report.counters.size(); i++) {
+        out << (i == 0 ? "" : ",") << jsonString(report.counters[i].first) << ":" << report.counters[i].second;
+    }
+    out << "}}" << endl;
+}
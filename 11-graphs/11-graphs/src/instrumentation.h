@@ -0,0 +1,134 @@
+/**
+ * File: instrumentation.h
+ * -----------------------
+ * Exports a small instrumentation layer for finding where a run spends
+ * its time.  Code marks itself up with three macros:
+ *
+ *   - INSTRUMENT_SCOPE(name) times the enclosing block,
+ *   - INSTRUMENT_COUNT(name, amount) adds to a named running total (lines
+ *     parsed, arcs created), and
+ *   - INSTRUMENT_SAMPLE(name, value) records a value at a point in time,
+ *     for quantities that change as a run goes on (the residual and the
+ *     edges traversed at each power iteration).
+ *
+ * Timestamps come from the steady clock in nanoseconds.  Everything
+ * recorded is handed to a sink when the run is done: a summary table for
+ * people, JSON lines for scripts, or Chrome's trace-event format, which
+ * chrome://tracing and ui.perfetto.dev draw as a timeline per thread.
+ *
+ * The macros compile to nothing unless GRAPHS_INSTRUMENT is defined (see
+ * graphs.pro), so ordinary builds pay nothing for them.  The rest of the
+ * interface is always there; without the flag it simply reports nothing.
+ */
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Type: InstrumentEvent
+ * ---------------------
+ * One recorded span (a timed block) or sample.  Times are in nanoseconds
+ * since instrumentation was first used; duration is only meaningful for
+ * spans and value only for samples.  thread numbers the recording threads
+ * in the order they first recorded something.
+ */
+struct InstrumentEvent {
+    enum Kind { Span, Sample };
+    Kind kind;
+    const char *name;
+    long long start;
+    long long duration;
+    double value;
+    int thread;
+};
+
+/**
+ * Type: InstrumentReport
+ * ----------------------
+ * Everything recorded so far: the spans and samples ordered by start
+ * time, and the final value of each counter in order of first use.
+ */
+struct InstrumentReport {
+    std::vector<InstrumentEvent> events;
+    std::vector<std::pair<std::string, long long>> counters;
+};
+
+/**
+ * Type: InstrumentSink
+ * --------------------
+ * Receives a report; writeInstrumentSummary, writeInstrumentJsonLines and
+ * writeChromeTrace below are the usual ones, bound to a stream.
+ */
+typedef std::function<void(const InstrumentReport& report)> InstrumentSink;
+
+/**
+ * Function: flushInstrumentation
+ * ------------------------------
+ * Hands everything recorded so far to sink and starts over.  It should be
+ * called while no instrumented work is running on other threads.
+ */
+void flushInstrumentation(const InstrumentSink& sink);
+
+/**
+ * Functions: writeInstrumentSummary, writeInstrumentJsonLines, writeChromeTrace
+ * ----------------------------------------------------------------------------
+ * Write a report as a table (calls, total, mean and longest time per span
+ * name, counter totals, and the count, first, last, least and greatest
+ * value per sample name), as one JSON object per line, or as a Chrome
+ * trace (spans as complete events, samples as counter tracks and counter
+ * totals under otherData).
+ */
+void writeInstrumentSummary(const InstrumentReport& report, std::ostream& out);
+void writeInstrumentJsonLines(const InstrumentReport& report, std::ostream& out);
+void writeChromeTrace(const InstrumentReport& report, std::ostream& out);
+
+/**
+ * Functions: instrumentNow, recordSpan, recordSample, instrumentCounter
+ * ---------------------------------------------------------------------
+ * What the macros expand to.  Names must be string literals (or otherwise
+ * outlive the report), since only the pointer is kept.  Each thread
+ * records into its own buffer, so threads do not contend.  A counter
+ * lives for the whole run; every use of the same name shares one.
+ */
+long long instrumentNow();
+void recordSpan(const char *name, long long start, long long end);
+void recordSample(const char *name, double value);
+std::atomic<long long>& instrumentCounter(const char *name);
+
+/**
+ * Class: ScopedTimer
+ * ------------------
+ * Records a span from its construction to the end of its scope.
+ */
+class ScopedTimer {
+public:
+    ScopedTimer(const char *name) : name(name), start(instrumentNow()) {}
+    ~ScopedTimer() { recordSpan(name, start, instrumentNow()); }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const char *name;
+    long long start;
+};
+
+#ifdef GRAPHS_INSTRUMENT
+#define INSTRUMENT_JOIN_(a, b) a##b
+#define INSTRUMENT_JOIN(a, b) INSTRUMENT_JOIN_(a, b)
+#define INSTRUMENT_SCOPE(name) ScopedTimer INSTRUMENT_JOIN(instrumentScope, __LINE__)(name)
+#define INSTRUMENT_COUNT(name, amount)                                                   \
+    do {                                                                                 \
+        static std::atomic<long long>& instrumentTotal = instrumentCounter(name);        \
+        instrumentTotal.fetch_add((long long) (amount), std::memory_order_relaxed);      \
+    } while (0)
+#define INSTRUMENT_SAMPLE(name, value) recordSample(name, (double) (value))
+#else
+#define INSTRUMENT_SCOPE(name) ((void) 0)
+#define INSTRUMENT_COUNT(name, amount) ((void) 0)
+#define INSTRUMENT_SAMPLE(name, value) ((void) 0)
+#endif
@@ -0,0 +1,115 @@
+#include "k-core.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include "parallel.h"
+using namespace std;
+
+// vertices are handed to threads in chunks of this many
+static const int kGrain = 1024;
+
+CoreNumbers coreDecomposition(const CompactGraph& g) {
+    CompactGraph simple = undirectedGraph(g);
+    int n = simple.numVertices();
+    vector<int> degree(n);
+    int maxDegree = 0;
+    for (int v = 0; v < n; v++) {
+        degree[v] = simple.outDegree(v);
+        maxDegree = max(maxDegree, degree[v]);
+    }
+
+    // order holds the vertices sorted by current degree, bucketStart[d] is
+    // where degree d begins and position[v] is where v sits
+    vector<int> bucketStart(maxDegree + 2, 0);
+    for (int v = 0; v < n; v++) bucketStart[degree[v] + 1]++;
+    for (int d = 0; d <= maxDegree; d++) bucketStart[d + 1] += bucketStart[d];
+    vector<int> order(n), position(n);
+    vector<int> cursor(bucketStart.begin(), bucketStart.end() - 1);
+    for (int v = 0; v < n; v++) {
+        position[v] = cursor[degree[v]]++;
+        order[position[v]] = v;
+    }
+
+    CoreNumbers cores;
+    cores.core.assign(n, 0);
+    cores.maxCore = 0;
+    for (int i = 0; i < n; i++) {
+        int v = order[i];
+        cores.core[v] = degree[v];
+        cores.maxCore = max(cores.maxCore, degree[v]);
+        for (size_t e = simple.offsets[v]; e < simple.offsets[v + 1]; e++) {
+            int u = simple.targets[e];
+            if (degree[u] <= degree[v]) continue;
+            // swap u to the front of its bucket, then shrink the bucket past it
+            int d = degree[u];
+            int front = order[bucketStart[d]];
+            swap(order[position[u]], order[bucketStart[d]]);
+            swap(position[u], position[front]);
+            bucketStart[d]++;
+            degree[u]--;
+        }
+    }
+    return cores;
+}
+
+CoreNumbers parallelCoreDecomposition(const CompactGraph& g, int numThreads) {
+    CompactGraph simple = undirectedGraph(g);
+    int n = simple.numVertices();
+    numThreads = resolveThreadCount(numThreads);
+    unique_ptr<atomic<int>[]> degree(new atomic<int>[n]);
+    CoreNumbers cores;
+    cores.core.assign(n, -1);
+    cores.maxCore = 0;
+    vector<int> alive(n);
+    for (int v = 0; v < n; v++) {
+        degree[v].store(simple.outDegree(v), memory_order_relaxed);
+        alive[v] = v;
+    }
+
+    vector<vector<int>> found(numThreads);
+    // moves what each thread found into wave
+    auto gather = [&found](vector<int>& wave) {
+        wave.clear();
+        for (vector<int>& part : found) {
+            wave.insert(wave.end(), part.begin(), part.end());
+            part.clear();
+        }
+    };
+
+    for (int k = 0; !alive.empty(); k++) {
+        vector<int> wave;
+        for (int v : alive) {
+            if (degree[v].load(memory_order_relaxed) <= k) {
+                cores.core[v] = k;
+                wave.push_back(v);
+            }
+        }
+        while (!wave.empty()) {
+            cores.maxCore = k;
+            parallelFor(0, wave.size(), kGrain, [&](int t, int lo, int hi) {
+                for (int i = lo; i < hi; i++) {
+                    int v = wave[i];
+                    for (size_t e = simple.offsets[v]; e < simple.offsets[v + 1]; e++) {
+                        int u = simple.targets[e];
+                        if (degree[u].load(memory_order_relaxed) <= k) continue;
+                        // exactly one decrement takes u from k + 1 to k, and that thread claims it
+                        if (degree[u].fetch_sub(1, memory_order_relaxed) == k + 1) {
+                            cores.core[u] = k;
+                            found[t].push_back(u);
+                        }
+                    }
+                }
+            }, numThreads);
+            gather(wave);
+        }
+        alive.erase(remove_if(alive.begin(), alive.end(), [&cores](int v) { return cores.core[v] >= 0; }),
+                    alive.end());
+    }
+    return cores;
+}
+
+CompactGraph pruneToCore(const CompactGraph& g, const CoreNumbers& cores, int k, vector<int> *originalIds) {
+    vector<bool> keep(g.numVertices());
+    for (int v = 0; v < g.numVertices(); v++) keep[v] = cores.core[v] >= k;
+    return inducedSubgraph(g, keep, originalIds);
+}
@@ -0,0 +1,54 @@
+/**
+ * File: k-core.h
+ * --------------
+ * Exports the k-core decomposition of a CompactGraph.  The k-core is what
+ * remains after repeatedly deleting every vertex with fewer than k
+ * neighbours, and a vertex's core number is the largest k whose core still
+ * holds it.  Pages stuck in low cores hang off the edge of the link graph
+ * and are mostly scraping noise, so pruning to a modest core before ranking
+ * shrinks the edge set every later sweep has to walk.  Link direction is
+ * ignored throughout, as are self loops and repeated links.
+ */
+
+#pragma once
+#include <vector>
+#include "compact-graph.h"
+
+/**
+ * Type: CoreNumbers
+ * -----------------
+ * core[v] is the core number of v and maxCore the largest of them.
+ */
+struct CoreNumbers {
+    std::vector<int> core;
+    int maxCore;
+};
+
+/**
+ * Function: coreDecomposition
+ * ---------------------------
+ * Peels vertices in order of current degree, keeping them in buckets by
+ * degree (Batagelj and Zaversnik), which takes O(n + m) time.
+ */
+CoreNumbers coreDecomposition(const CompactGraph& g);
+
+/**
+ * Function: parallelCoreDecomposition
+ * -----------------------------------
+ * Computes the same core numbers level by level: every vertex whose degree
+ * is at most k is peeled at once, in parallel, lowering its neighbours'
+ * degrees with atomics; any neighbour that drops to k joins the next wave
+ * of the same level.  Each level also rescans the surviving vertices, so
+ * this pays off when the largest core number is small next to n.
+ */
+CoreNumbers parallelCoreDecomposition(const CompactGraph& g, int numThreads = 0);
+
+/**
+ * Function: pruneToCore
+ * ---------------------
+ * Returns the subgraph of g on the vertices with core number at least k
+ * (see inducedSubgraph for originalIds).  Only vertices are dropped; the
+ * surviving links keep their direction.
+ */
+CompactGraph pruneToCore(const CompactGraph& g, const CoreNumbers& cores, int k,
+                         std::vector<int> *originalIds = nullptr);
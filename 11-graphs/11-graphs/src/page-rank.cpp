@@ -9,6 +9,7 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <algorithm>
 #include "graphs.h"
 #include "graph-display.h"
 #include "graph-constants.h"
@@ -21,11 +22,33 @@
 #include "grid.h"
 #include "pqueue.h"
 #include <cmath>
+#include "block-rank.h"
+#include "fingerprint-index.h"
+#include "communities.h"
+#include "connected-components.h"
+#include "graph-conversion.h"
+#include "instrumentation.h"
+#include "k-core.h"
+#include "personalized-rank.h"
+#include "rank-engine.h"
+#include "rank-server.h"
+#include "rank-snapshot.h"
+#include "rank-store.h"
+#include "strong-components.h"
+#include "triangles.h"
+#include "warm-start.h"
 //#include "pqueue-heap-pagerank.h"
 using namespace std;
 
+// connected fragments smaller than this are dropped before ranking
+static const int kMinComponentSize = 5;
+
+// pages outside the k-core for this k are pruned before ranking
+static const int kMinCoreness = 2;
+
 // makes a hashset based on each line in fileName
 HashSet<string> buildEntities(const string& fileName) {
+    INSTRUMENT_SCOPE("buildEntities");
     ifstream stream;
     stream.open(fileName.c_str());
     string line;
@@ -39,11 +62,13 @@ HashSet<string> buildEntities(const string& fileName) {
 // uses the hashset and a file to construct a graph with entites as nodes
 // connections are bidirectional
 graph buildGraph(const string& fileName, const HashSet<string>& set) {
+    INSTRUMENT_SCOPE("buildGraph");
     ifstream stream;
     stream.open(fileName.c_str());
     string line;
     graph g;
     while (getline(stream, line)) {
+        INSTRUMENT_COUNT("lines parsed", 1);
         // vector of words in line
         // prevents cases in which false entities are deliniated by space
         Vector<string> lineVec;
@@ -54,7 +79,6 @@ graph buildGraph(const string& fileName, const HashSet<string>& set) {
             loc = line.find(" ");
         }
         lineVec.add(line);
-        cout << lineVec << endl;
 
         Set<string> subset;
         for (string str : lineVec) if (set.contains(str)) subset.add(str);
@@ -84,33 +108,24 @@ graph buildGraph(const string& fileName, const HashSet<string>& set) {
                     g.index.get(two)->arcs.add(backward);
                     g.arcs.add(forward);
                     g.arcs.add(backward);
+                    INSTRUMENT_COUNT("arcs created", 2);
                 }
             }
             remaining.remove(one);
         }
-
-        cout << endl;
     }
     return g;
 }
 
-// builds a graph using the wikipedia reference structure
+// adds the wikipedia references in fileName between nodes already in g
 // references are directional
-graph buildWikipediaGraph(const string& fileName, const HashSet<string>& set) {
+void addWikipediaLinks(graph& g, const string& fileName, const HashSet<string>& set) {
+    INSTRUMENT_SCOPE("addWikipediaLinks");
     ifstream stream;
     stream.open(fileName.c_str());
     string line;
-    graph g;
-    for (string str : set) {
-        if (!g.index.containsKey(str)) {
-            node * n = new node();
-            n->name = str;
-            g.index.put(str, n);
-            g.nodes.add(n);
-        }
-    }
-    int count = 1;
     while(getline(stream, line)) {
+        INSTRUMENT_COUNT("lines parsed", 2);
         node * n = g.index.get(line);
         if (n==nullptr) { // this will never happen when processSet isn't run
             getline(stream, line);
@@ -146,14 +161,31 @@ graph buildWikipediaGraph(const string& fileName, const HashSet<string>& set) {
 
                 n->arcs.add(forward);
                 g.arcs.add(forward);
+                INSTRUMENT_COUNT("arcs created", 1);
             }
         }
     };
+}
+
+// builds a graph using the wikipedia reference structure
+// references are directional
+graph buildWikipediaGraph(const string& fileName, const HashSet<string>& set) {
+    graph g;
+    for (string str : set) {
+        if (!g.index.containsKey(str)) {
+            node * n = new node();
+            n->name = str;
+            g.index.put(str, n);
+            g.nodes.add(n);
+        }
+    }
+    addWikipediaLinks(g, fileName, set);
     return g;
 }
 
 // builds a Markov matrix from a graph
 // bias will average the markov with a steady state
+// pages without links leave an all-zero column (RankEngine spreads their rank instead)
 Grid<double> makeMarkov(const graph& g, const double& bias = 0.15) {
     Vector<string> node_order = g.index.keys();
     Map<string, int> nodeIndex; int count = 0;
@@ -208,8 +240,7 @@ Grid<double> multiplyMatrices(const Grid<double>& one, const Grid<double>& two)
         cout << "Invalid Matrix Multiplication!" << endl;
         return prod;
     }
-    cout << "Doing matrix multiplication! This takes time. Your multiplication will produce " << prod.numRows() << " rows." << endl;;
-    cout << "We will print one . for each 50 rows calculated and you can expect " << prod.numRows()/50 << " .s\n" << endl;
+    INSTRUMENT_SCOPE("multiplyMatrices");
     for (int i = 0; i < prod.numRows(); i++) {
         for (int j = 0; j < prod.numCols(); j++) {
             double sum = 0;
@@ -219,10 +250,8 @@ Grid<double> multiplyMatrices(const Grid<double>& one, const Grid<double>& two)
             }
             prod.set(i, j, sum);
         }
-        if (i%50==0)
-            cout << "." << endl;
+        INSTRUMENT_COUNT("matrix rows multiplied", 1);
     }
-    cout << endl;
     return prod;
 }
 
@@ -260,6 +289,41 @@ void getRank(const graph& g, const Grid<double>& grid, const int& topVals=100) {
     }
 }
 
+// takes compact graph and its rank vector, printing the top 100 values (by default)
+void getRank(const CompactGraph& cg, const vector<double>& ranks, const int& topVals=100) {
+    PriorityQueue<int> pq;
+    Stack<int> colSorted;
+    for (int i = 0 ; i < (int) ranks.size(); i++) {
+        pq.add(i, ranks[i]);
+    }
+    while (!pq.isEmpty()) {
+        colSorted.push(pq.dequeue());
+    }
+    for (int i = 1 ; i <= topVals; i++) {
+        if (colSorted.isEmpty()) return;
+        int index = colSorted.pop();
+        cout << i <<  " - " << cg.names[index] << "     " << ranks[index] << endl;
+    }
+}
+
+//prints the highest ranked pages of each of the largest communities
+void getCommunityRank(const CompactGraph& cg, const vector<double>& ranks, const Communities& communities,
+                      const int& topCommunities=10, const int& topVals=5) {
+    cout << communities.numCommunities << " communities, modularity " << communities.modularity << endl;
+    Vector<PriorityQueue<int>> pqs(min(topCommunities, communities.numCommunities));
+    for (int i = 0 ; i < (int) ranks.size(); i++) {
+        int c = communities.community[i];
+        if (c < pqs.size()) pqs[c].add(i, -ranks[i]);
+    }
+    for (int c = 0; c < pqs.size(); c++) {
+        cout << "Community " << c << " (" << communities.sizes[c] << " pages)" << endl;
+        for (int i = 1 ; i <= topVals && !pqs[c].isEmpty(); i++) {
+            int index = pqs[c].dequeue();
+            cout << "    " << i <<  " - " << cg.names[index] << "     " << ranks[index] << endl;
+        }
+    }
+}
+
 // calculates the euclidean distance between the first two columns
 double euclidDistance(const Grid<double>& grid) {
     double error = 0.0;
@@ -356,19 +420,271 @@ void wikipedaPR() {
     //read input.txt and make graph
     graph g = buildWikipediaGraph("high-budget.txt", set);
 
-    //make markov
-    Grid<double> matrix = makeMarkov(g);
-    cout << "Made the Markov Matrix!!" << endl;
+    //drop tiny disconnected fragments and the loosely attached fringe, then find dangling pages and sink components
+    CompactGraph cg = toCompactGraph(g);
+    ConnectedComponents fragments = findConnectedComponents(cg);
+    cg = dropSmallComponents(cg, fragments, kMinComponentSize);
+    cout << "Kept " << cg.numVertices() << " of " << g.nodes.size() << " pages in components of at least "
+         << kMinComponentSize << endl;
+    size_t edgesBefore = cg.numEdges();
+    cg = pruneToCore(cg, parallelCoreDecomposition(cg), kMinCoreness);
+    cout << "Kept " << cg.numVertices() << " pages and " << cg.numEdges() << " of " << edgesBefore
+         << " links in the " << kMinCoreness << "-core" << endl;
+    GraphAnalysis analysis = analyzeGraph(cg);
+    reportGraphAnalysis(cg, analysis);
+
+    // solve component by component rather than squaring the dense markov matrix
+    RankEngine engine(cg);
+    RankResult result = engine.solveByComponents(analysis.components);
+    cout << "Finished Iteration!! (residual " << result.residual << ")" << endl;
+    getRank(cg, result.ranks);
+
+    //group pages that link densely among themselves
+    getCommunityRank(cg, result.ranks, detectCommunities(cg));
+}
+
+//builds one graph out of several scraped datasets; dataset maps each page to
+//the index of the first names file that lists it
+graph buildCombinedGraph(const Vector<string>& nameFiles, const Vector<string>& linkFiles,
+                         Map<string, int>& dataset) {
+    HashSet<string> set;
+    for (int i = 0; i < nameFiles.size(); i++) {
+        HashSet<string> names = buildEntities(nameFiles[i]);
+        processSet(names);
+        for (string str : names) {
+            if (dataset.containsKey(str)) continue;
+            dataset.put(str, i);
+            set.add(str);
+        }
+    }
+    graph g = buildWikipediaGraph(linkFiles[0], set);
+    for (int i = 1; i < linkFiles.size(); i++) addWikipediaLinks(g, linkFiles[i], set);
+    return g;
+}
+
+// ranks several datasets as one graph, using BlockRank with each page's dataset as its block
+void wikipediaBlockPR() {
+    Vector<string> nameFiles = {"high-budget-names.txt", "programming-languages-names.txt", "philosopher-names-v3.txt"};
+    Vector<string> linkFiles = {"high-budget.txt", "programming-languages.txt", "philosopher-links-v3.txt"};
+
+    // a page belongs to the first dataset that lists it
+    Map<string, int> dataset;
+    graph g = buildCombinedGraph(nameFiles, linkFiles, dataset);
+
+    CompactGraph cg = toCompactGraph(g);
+    vector<int> block(cg.numVertices());
+    for (int v = 0; v < cg.numVertices(); v++) block[v] = dataset.get(cg.names[v]);
+
+    RankEngine engine(cg);
+    BlockRankStats stats;
+    RankResult result = solveBlockRank(engine, cg, block, RankOptions(), &stats);
+    cout << "Finished Iteration!! " << stats.numBlocks << " blocks, " << stats.globalIterations
+         << " global iterations (residual " << result.residual << ")" << endl;
+    getRank(cg, result.ranks);
+}
+
+//lists the entities in the most triangles of the co-occurrence graph; a
+//clustering coefficient near 1 means their neighbours all co-occur too
+void cooccurrenceCliques(const int& topVals=20) {
+    HashSet<string> set = buildEntities("entities.txt");
+    graph g = buildGraph("input.txt", set);
+    CompactGraph cg = undirectedGraph(toCompactGraph(g));
+    TriangleCounts counts = countTriangles(cg);
+    cout << counts.total << " triangles, average clustering " << counts.averageClustering
+         << ", transitivity " << counts.transitivity << endl;
+
+    PriorityQueue<int> pq;
+    for (int i = 0; i < cg.numVertices(); i++) {
+        pq.add(i, -counts.perVertex[i]);
+    }
+    for (int i = 1; i <= topVals && !pq.isEmpty(); i++) {
+        int index = pq.dequeue();
+        cout << i << " - " << cg.names[index] << "     " << counts.perVertex[index]
+             << " triangles, clustering " << counts.clustering[index];
+        vector<pair<int, double>> similar = mostSimilar(cg, index, 1);
+        if (!similar.empty()) cout << ", closest to " << cg.names[similar[0].first];
+        cout << endl;
+    }
+}
+
+//returns the vertex of cg titled name, or -1 if there is none
+int findPage(const CompactGraph& cg, const string& name) {
+    for (int i = 0; i < cg.numVertices(); i++) {
+        if (cg.names[i] == name) return i;
+    }
+    return -1;
+}
+
+//ranks the combined graph once per scraped topic list, personalized to that list's pages;
+//all the topics are solved together so each sweep reads the links only once
+void topicPR(const int& topVals=10) {
+    Vector<string> nameFiles = {"high-budget-names.txt", "programming-languages-names.txt", "philosopher-names-v3.txt",
+                                "countries-names.txt", "sp500-names.txt"};
+    Vector<string> linkFiles = {"high-budget.txt", "programming-languages.txt", "philosopher-links-v3.txt"};
+    Map<string, int> dataset;
+    graph g = buildCombinedGraph(nameFiles, linkFiles, dataset);
+    CompactGraph cg = toCompactGraph(g);
+
+    vector<vector<int>> seedSets(nameFiles.size());
+    for (int v = 0; v < cg.numVertices(); v++) seedSets[dataset.get(cg.names[v])].push_back(v);
+    Vector<string> topics;
+    vector<vector<int>> nonEmpty;
+    // countries and companies only appear as link targets; with no links of
+    // their own scraped, their pages make no topic to personalize to
+    for (int i = 0; i < linkFiles.size(); i++) {
+        if (seedSets[i].empty()) continue;
+        topics.add(nameFiles[i]);
+        nonEmpty.push_back(seedSets[i]);
+    }
+
+    RankEngine engine(cg);
+    vector<RankResult> results = engine.solvePersonalized(nonEmpty);
+    for (int i = 0; i < topics.size(); i++) {
+        cout << "Personalized to " << topics[i] << " (" << results[i].iterations << " iterations)" << endl;
+        getRank(cg, results[i].ranks, topVals);
+    }
+}
+
+//the philosopher link graph the local queries below run on
+CompactGraph philosopherGraph() {
+    HashSet<string> set = buildEntities("philosopher-names-v3.txt");
+    processSet(set);
+    graph g = buildWikipediaGraph("philosopher-links-v3.txt", set);
+    return toCompactGraph(g);
+}
+
+//ranks the philosophers by how related they are to seedName, touching only the pages near it
+void relatedPages(const string& seedName, const int& topVals=20) {
+    CompactGraph cg = philosopherGraph();
+    int seed = findPage(cg, seedName);
+    if (seed < 0) {
+        cout << seedName << " is not in the graph" << endl;
+        return;
+    }
+
+    PersonalizedRankEngine engine(cg);
+    LocalRankResult result = engine.forwardPush({seed});
+    cout << "Pages related to " << seedName << " (" << result.pushes << " pushes)" << endl;
+    for (int i = 1; i <= topVals && i <= (int) result.ranks.size(); i++) {
+        int index = result.ranks[i - 1].first;
+        cout << i << " - " << cg.names[index] << "     " << result.ranks[i - 1].second << endl;
+    }
+}
 
-    // iterate on matrix by squaring it n times
-    Grid<double> iterate = logIterateMultiply(matrix, 8, g);
-    cout << "Finished Iteration!!" << endl;
+//answers relatedPages from stored random-walk fingerprints, building and saving them on first use
+void fingerprintRelated(const string& seedName, const string& indexFile="philosopher-fingerprints.idx",
+                        const int& topVals=20) {
+    CompactGraph cg = philosopherGraph();
+    int seed = findPage(cg, seedName);
+    if (seed < 0) {
+        cout << seedName << " is not in the graph" << endl;
+        return;
+    }
 
+    ifstream existing(indexFile.c_str());
+    if (!existing) FingerprintIndex(cg).save(indexFile);
+    FingerprintIndex index(indexFile);
+    if (index.numVertices() != cg.numVertices()) {
+        cout << indexFile << " was built for a different graph" << endl;
+        return;
+    }
+    vector<pair<int, double>> ranks = index.estimate({seed}, topVals);
+    cout << "Pages related to " << seedName << " (" << index.walksPerVertex() << " walks)" << endl;
+    for (int i = 1; i <= (int) ranks.size(); i++) {
+        cout << i << " - " << cg.names[ranks[i - 1].first] << "     " << ranks[i - 1].second << endl;
+    }
+}
+
+//lists the pages whose surfers end up on pageName most often, i.e. what drives its rank
+void explainRank(const string& pageName, const int& topVals=20) {
+    CompactGraph cg = philosopherGraph();
+    int target = findPage(cg, pageName);
+    if (target < 0) {
+        cout << pageName << " is not in the graph" << endl;
+        return;
+    }
+
+    PersonalizedRankEngine engine(cg);
+    LocalRankResult result = engine.reversePush(target);
+    cout << "Pages contributing to " << pageName << " (" << result.pushes << " pushes)" << endl;
+    int count = 0;
+    for (const pair<int, double>& contributor : result.ranks) {
+        int index = contributor.first;
+        if (index == target) continue;
+        if (++count > topVals) break;
+        const int *links = cg.targets.data() + cg.offsets[index];
+        bool direct = binary_search(links, links + cg.outDegree(index), target);
+        cout << count << " - " << cg.names[index] << "     " << contributor.second
+             << (direct ? " (links directly)" : "") << endl;
+    }
+}
+
+//reranks the philosophers starting from an earlier run (a saved output or a .snapshot), then
+//shows how the top pages move as the bias changes
+void warmStartPR(const string& previousFile="../../Outputs/Philosopher-Output.txt", const int& topVals=5) {
+    CompactGraph cg = philosopherGraph();
+    bool isSnapshot = previousFile.size() > 9 && previousFile.compare(previousFile.size() - 9, 9, ".snapshot") == 0;
+    unordered_map<string, double> previous = isSnapshot ? snapshotRanks(*loadRankSnapshot(previousFile))
+                                                         : readRankOutput(previousFile);
+    int matched;
+    vector<double> initial = warmStartRanks(cg, previous, &matched);
+
+    RankEngine engine(cg);
+    RankResult cold = engine.solve();
+    RankResult warm = engine.solve(RankOptions(), initial);
+    cout << "Matched " << matched << " of " << previous.size() << " earlier ranks; " << warm.iterations
+         << " iterations instead of " << cold.iterations << endl;
+
+    vector<double> biases = {0.05, 0.1, 0.15, 0.2, 0.25, 0.3};
+    vector<RankResult> sweep = engine.solveDampingSweep(biases);
+    for (int i = 0; i < (int) biases.size(); i++) {
+        cout << "Bias " << biases[i] << " (" << sweep[i].iterations << " iterations)" << endl;
+        getRank(cg, sweep[i].ranks, topVals);
+    }
+}
+
+//serves the high-budget ranks over HTTP on localhost, answering from the saved snapshot (if any) while a fresh solve runs
+void servePR(const string& snapshotFile="high-budget.snapshot", const int& port=8080) {
+    auto recompute = [snapshotFile]() {
+        HashSet<string> set = buildEntities("high-budget-names.txt");
+        processSet(set);
+        CompactGraph cg = toCompactGraph(buildWikipediaGraph("high-budget.txt", set));
+        // resumes an interrupted solve, or warm starts from the last one
+        RankOptions options;
+        options.checkpointFile = snapshotFile + ".checkpoint";
+        RankEngine engine(cg);
+        shared_ptr<const RankSnapshot> snapshot = makeRankSnapshot(cg, engine.solve(options).ranks);
+        saveRankSnapshot(*snapshot, snapshotFile);
+        return snapshot;
+    };
+    ifstream existing(snapshotFile.c_str());
+    RankStore store(existing ? loadRankSnapshot(snapshotFile) : recompute());
+    // the scrape may have moved on since the snapshot was saved, so refresh it while serving
+    if (existing) store.refreshInBackground(recompute);
+    RankServer server(store);
+    cout << "Serving ranks on http://localhost:" << port << "/top" << endl;
+    server.serve(port);
 }
 
 int main() {
 
     wikipedaPR();
-
+    //wikipediaBlockPR();
+    //topicPR();
+    //cooccurrenceCliques();
+    //relatedPages("Immanuel Kant");
+    //fingerprintRelated("Immanuel Kant");
+    //explainRank("Edward N. Zalta");
+    //warmStartPR();
+    //servePR();
+
+#ifdef GRAPHS_INSTRUMENT
+    // the trace opens in chrome://tracing or ui.perfetto.dev
+    flushInstrumentation([](const InstrumentReport& report) {
+        writeInstrumentSummary(report, cout);
+        ofstream trace("page-rank-trace.json");
+        writeChromeTrace(report, trace);
+    });
+#endif
     return 0;
 }
@@ -0,0 +1,99 @@
+/**
+ * File: parallel.h
+ * ----------------
+ * Presents a couple of small helpers for splitting loops across
+ * std::threads.  Work is handed out in chunks from a shared counter,
+ * so uneven iterations (BFS from a hub vs. from a leaf) still balance.
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * Function: resolveThreadCount
+ * ----------------------------
+ * Returns requested if it is positive, and otherwise the number of
+ * hardware threads (never less than one).
+ */
+inline int resolveThreadCount(int requested) {
+    if (requested > 0) return requested;
+    int hardware = (int) std::thread::hardware_concurrency();
+    return std::max(1, hardware);
+}
+
+/**
+ * Function: parallelRun
+ * ---------------------
+ * Calls body(threadIndex) once on each of numThreads threads and waits
+ * for all of them.  Thread 0 is the calling thread.
+ */
+template <typename Body>
+void parallelRun(int numThreads, Body body) {
+    numThreads = resolveThreadCount(numThreads);
+    std::vector<std::thread> workers;
+    for (int t = 1; t < numThreads; t++) {
+        workers.push_back(std::thread([&body, t]() { body(t); }));
+    }
+    body(0);
+    for (std::thread& worker : workers) worker.join();
+}
+
+/**
+ * Function: parallelFor
+ * ---------------------
+ * Splits [begin, end) into chunks of at most grain iterations and calls
+ * body(threadIndex, chunkBegin, chunkEnd) for each chunk.  threadIndex is
+ * in [0, numThreads) so callers can keep per-thread scratch space.
+ */
+template <typename Body>
+void parallelFor(int begin, int end, int grain, Body body, int numThreads = 0) {
+    if (begin >= end) return;
+    grain = std::max(1, grain);
+    numThreads = std::min(resolveThreadCount(numThreads), (end - begin + grain - 1) / grain);
+    if (numThreads <= 1) {
+        for (int lo = begin; lo < end; lo += grain) body(0, lo, std::min(end, lo + grain));
+        return;
+    }
+    std::atomic<int> next(begin);
+    parallelRun(numThreads, [&](int t) {
+        while (true) {
+            int lo = next.fetch_add(grain);
+            if (lo >= end) break;
+            body(t, lo, std::min(end, lo + grain));
+        }
+    });
+}
+
+/**
+ * Function: parallelSort
+ * ----------------------
+ * Sorts v with less, sorting one slice per thread and then merging
+ * neighbouring slices in parallel rounds.  Falls back to std::sort for
+ * small inputs, where the threads would cost more than they save.
+ */
+template <typename T, typename Less>
+void parallelSort(std::vector<T>& v, Less less, int numThreads = 0) {
+    const std::size_t kSequentialCutoff = 1 << 16;
+    numThreads = resolveThreadCount(numThreads);
+    if (numThreads <= 1 || v.size() < kSequentialCutoff) {
+        std::sort(v.begin(), v.end(), less);
+        return;
+    }
+    std::vector<std::size_t> bounds;
+    for (int t = 0; t <= numThreads; t++) bounds.push_back(v.size() * t / numThreads);
+    parallelRun(numThreads, [&](int t) {
+        std::sort(v.begin() + bounds[t], v.begin() + bounds[t + 1], less);
+    });
+    for (int width = 1; width < numThreads; width *= 2) {
+        int numMerges = (numThreads + 2 * width - 1) / (2 * width);
+        parallelRun(numMerges, [&](int m) {
+            int lo = m * 2 * width, mid = lo + width, hi = std::min(lo + 2 * width, numThreads);
+            if (mid >= hi) return;
+            std::inplace_merge(v.begin() + bounds[lo], v.begin() + bounds[mid],
+                               v.begin() + bounds[hi], less);
+        });
+    }
+}
@@ -0,0 +1,144 @@
+#include "personalized-rank.h"
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include "engine-error.h"
+#include "pqueue-heap-pagerank.h"
+using namespace std;
+
+// what a query knows about one touched vertex
+struct PushState {
+    double estimate = 0;
+    double residual = 0;
+    bool queued = false;
+};
+
+typedef unordered_map<int, PushState> PushStates;
+
+// the vertices waiting to be pushed, in either order
+class PushQueue {
+public:
+    PushQueue(PushOrder order) : order(order) {}
+
+    bool isEmpty() const { return order == kFifoOrder ? fifo.empty() : heap.isEmpty(); }
+
+    // queues v, or updates its priority if it is already queued
+    void offer(int v, double priority) {
+        if (order == kFifoOrder) {
+            fifo.push_back(v);
+        } else {
+            heap.enqueueOrUpdate(v, priority);
+        }
+    }
+
+    int take() {
+        if (order == kLargestResidualOrder) return heap.extractMin().index;
+        int v = fifo.front();
+        fifo.pop_front();
+        return v;
+    }
+
+private:
+    PushOrder order;
+    deque<int> fifo;
+    HeapPQueuePR<int, double, 4, greater<double>> heap;
+};
+
+// sorts the nonzero estimates, highest first
+static LocalRankResult collectRanks(const PushStates& states, int pushes) {
+    LocalRankResult result;
+    result.pushes = pushes;
+    result.residual = 0;
+    for (const auto& entry : states) {
+        if (entry.second.estimate > 0) result.ranks.push_back(make_pair(entry.first, entry.second.estimate));
+        result.residual += entry.second.residual;
+    }
+    sort(result.ranks.begin(), result.ranks.end(), [](const pair<int, double>& a, const pair<int, double>& b) {
+        return a.second > b.second || (a.second == b.second && a.first < b.first);
+    });
+    return result;
+}
+
+PersonalizedRankEngine::PersonalizedRankEngine(const CompactGraph& g)
+    : outgoing(g), incoming(transposeGraph(g)) {
+    outgoing.costs.clear();
+    outgoing.arcs.clear();
+    incoming.costs.clear();
+    incoming.arcs.clear();
+}
+
+LocalRankResult PersonalizedRankEngine::forwardPush(const vector<int>& seeds, const LocalRankOptions& options) const {
+    if (seeds.empty()) error("PersonalizedRankEngine::forwardPush: no seeds");
+    for (int s : seeds) {
+        if (s < 0 || s >= numVertices()) error("PersonalizedRankEngine::forwardPush: seed out of range");
+    }
+    PushStates states;
+    PushQueue queue(options.order);
+    // pushes v if it holds more residual than its links can carry within tolerance
+    auto add = [&](int v, double mass) {
+        PushState& state = states[v];
+        state.residual += mass;
+        int links = max(1, outgoing.outDegree(v));
+        if (state.residual > options.tolerance * links) {
+            if (!state.queued || options.order == kLargestResidualOrder) queue.offer(v, state.residual / links);
+            state.queued = true;
+        }
+    };
+    double seedMass = 1.0 / seeds.size();
+    for (int s : seeds) add(s, seedMass);
+
+    int pushes = 0;
+    while (!queue.isEmpty()) {
+        int v = queue.take();
+        PushState& state = states[v];
+        state.queued = false;
+        double mass = state.residual;
+        state.residual = 0;
+        state.estimate += options.bias * mass;
+        double passed = (1 - options.bias) * mass;
+        pushes++;
+        int links = outgoing.outDegree(v);
+        if (links == 0) {
+            for (int s : seeds) add(s, passed * seedMass);
+        } else {
+            for (size_t e = outgoing.offsets[v]; e < outgoing.offsets[v + 1]; e++) {
+                add(outgoing.targets[e], passed / links);
+            }
+        }
+    }
+    return collectRanks(states, pushes);
+}
+
+LocalRankResult PersonalizedRankEngine::reversePush(int target, const LocalRankOptions& options) const {
+    if (target < 0 || target >= numVertices()) error("PersonalizedRankEngine::reversePush: target out of range");
+    PushStates states;
+    PushQueue queue(options.order);
+    auto add = [&](int v, double mass) {
+        PushState& state = states[v];
+        state.residual += mass;
+        if (state.residual > options.tolerance) {
+            if (!state.queued || options.order == kLargestResidualOrder) queue.offer(v, state.residual);
+            state.queued = true;
+        }
+    };
+    add(target, 1.0);
+
+    int pushes = 0;
+    while (!queue.isEmpty()) {
+        int v = queue.take();
+        PushState& state = states[v];
+        state.queued = false;
+        double mass = state.residual;
+        state.residual = 0;
+        state.estimate += options.bias * mass;
+        double passed = (1 - options.bias) * mass;
+        pushes++;
+        // w reaches v through one of its out-links
+        for (size_t e = incoming.offsets[v]; e < incoming.offsets[v + 1]; e++) {
+            int w = incoming.targets[e];
+            add(w, passed / outgoing.outDegree(w));
+        }
+    }
+    return collectRanks(states, pushes);
+}
@@ -0,0 +1,98 @@
+/**
+ * File: personalized-rank.h
+ * -------------------------
+ * Exports local personalized PageRank.  A personalized surfer teleports
+ * back to a set of seed pages rather than to a uniformly random page, so
+ * its ranks measure how related each page is to the seeds.  The push
+ * algorithms here only ever touch the pages near the seeds, so a query
+ * costs about the same on a graph of a thousand pages as on one of a million.
+ */
+
+#pragma once
+#include <utility>
+#include <vector>
+#include "compact-graph.h"
+
+/**
+ * Type: PushOrder
+ * ---------------
+ * The order in which vertices with too much residual are pushed: first in,
+ * first out, or largest residual per out-link first through a HeapPQueuePR.
+ * The heap tends to need fewer pushes for the same accuracy but pays
+ * O(log n) for each.
+ */
+enum PushOrder { kFifoOrder, kLargestResidualOrder };
+
+/**
+ * Type: LocalRankOptions
+ * ----------------------
+ * bias is the teleport probability, as in RankOptions.  A forward push
+ * continues while some vertex holds more than tolerance residual per
+ * out-link, and a reverse push while some vertex holds more than tolerance.
+ * Estimates only ever fall short of the true values; larger tolerances
+ * answer faster and touch fewer pages.
+ */
+struct LocalRankOptions {
+    double bias = 0.15;
+    double tolerance = 1e-6;
+    PushOrder order = kFifoOrder;
+};
+
+/**
+ * Type: LocalRankResult
+ * ---------------------
+ * ranks holds (vertex, estimate) for every vertex with a nonzero estimate,
+ * highest first.  pushes counts the push operations, and residual is the
+ * rank mass not yet handed out (the total error of the estimates).
+ */
+struct LocalRankResult {
+    std::vector<std::pair<int, double>> ranks;
+    int pushes;
+    double residual;
+};
+
+/**
+ * Class: PersonalizedRankEngine
+ * -----------------------------
+ * Holds the out-edges and in-edges of a graph for repeated local queries.
+ * As in RankEngine, each link of a page is followed with equal probability;
+ * in a forward push, a surfer on a dangling page returns to the seeds.
+ */
+class PersonalizedRankEngine {
+public:
+    PersonalizedRankEngine(const CompactGraph& g);
+
+    /**
+     * Method: forwardPush
+     * -------------------
+     * Approximates personalized PageRank for the seeds (weighted equally)
+     * with the forward push of Andersen, Chung and Lang.  All the seed mass
+     * starts as residual; pushing a vertex keeps bias of its residual as
+     * settled rank and passes the rest on along its out-links, and pushing
+     * stops once no vertex holds more than tolerance per out-link.
+     */
+    LocalRankResult forwardPush(const std::vector<int>& seeds,
+                                const LocalRankOptions& options = LocalRankOptions()) const;
+
+    /**
+     * Method: reversePush
+     * -------------------
+     * Finds which pages contribute most to target's rank, by the reverse
+     * push of Andersen, Borgs, Chayes, Hopcroft, Mirrokni and Teng.  The
+     * contribution of u is the personalized rank of target for the seed u:
+     * the chance that a surfer starting at u, who stops at each step with
+     * probability bias, stops at target.  Residual starts on target and
+     * flows backward over in-links, so only pages that can reach target are
+     * touched, and every estimate ends up within tolerance of its value.
+     * A surfer that reaches a dangling page stops there, so where dangling
+     * pages are reachable these are lower bounds on what forwardPush from u
+     * would give target.  residual in the result is the mass still unpushed.
+     */
+    LocalRankResult reversePush(int target, const LocalRankOptions& options = LocalRankOptions()) const;
+
+    int numVertices() const { return outgoing.numVertices(); }
+
+private:
+    CompactGraph outgoing;
+    CompactGraph incoming;
+};
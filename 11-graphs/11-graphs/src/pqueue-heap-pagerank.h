@@ -1,33 +1,230 @@
 #pragma once
+#include <algorithm>
+#include <functional>
 #include <string>
+#include <vector>
 
-
-struct phil {
-    int index;
-    double val;
+/**
+ * Type: PQEntry
+ * -------------
+ * One element of a HeapPQueuePR: the key (a vertex ID) and its value,
+ * which is the priority it is ordered by.
+ */
+template <typename Key, typename Value>
+struct PQEntry {
+    Key index;
+    Value val;
 };
 
+typedef PQEntry<int, double> phil;
 
+/**
+ * Class: HeapPQueuePR
+ * -------------------
+ * An indexed d-ary min-heap.  Keys are small non-negative integers (vertex
+ * IDs), each present at most once, and a position map from key to heap slot
+ * lets a queued key have its value changed in O(log n).  A 4-ary layout
+ * keeps a node's children in one cache line and halves the tree height
+ * compared to a binary heap.  Compare decides which value comes out first;
+ * pass std::greater to get a max-heap.
+ */
+template <typename Key = int, typename Value = double, int Arity = 4,
+          typename Compare = std::less<Value>>
 class HeapPQueuePR {
 public:
-    HeapPQueuePR();
-    ~HeapPQueuePR();
-	
+    typedef PQEntry<Key, Value> entry;
+
+    HeapPQueuePR(Key capacity = 0);
+
     static HeapPQueuePR *merge(HeapPQueuePR *one, HeapPQueuePR *two);
-	
-    void enqueue(const phil& elem);
-    phil extractMin();
-    const phil& peek() const;
-    int size() const { return logSize; }
-    
+
+    void enqueue(const entry& elem);
+    entry extractMin();
+    const entry& peek() const { return heap[0]; }
+    int size() const { return (int) heap.size(); }
+    bool isEmpty() const { return heap.empty(); }
+
+    bool contains(Key index) const;
+    const Value& valueOf(Key index) const { return heap[position[index]].val; }
+
+    // enqueues index with val, or moves it to val if it is already queued
+    void enqueueOrUpdate(Key index, const Value& val);
+    void decreaseKey(Key index, const Value& val);
+    void increaseKey(Key index, const Value& val);
+    void remove(Key index);
+    void clear();
+
+    // replaces the contents with vals[0 .. n-1] keyed 0 .. n-1, in O(n)
+    void build(const Value *vals, Key n);
+
 private:
-    // provide data methods and helper methods to
-    // help realize the binary heap-backed PQueue
-    phil *heap;
-    int heapMaxSize;
-    int logSize;
-    void heapify(const int& index);
-    void resize(const int& newLen);
+    enum { kNotQueued = -1 };
+    std::vector<entry> heap;
+    std::vector<int> position;
+    Compare before;
+
+    void place(int slot, const entry& elem);
+    void bubbleUp(int slot);
+    void heapify(int slot);
+    void heapifyAll();
+    void ensureCapacity(Key index);
 };
 
+template <typename Key, typename Value, int Arity, typename Compare>
+HeapPQueuePR<Key, Value, Arity, Compare>::HeapPQueuePR(Key capacity) : position(capacity, kNotQueued) {}
+
+template <typename Key, typename Value, int Arity, typename Compare>
+bool HeapPQueuePR<Key, Value, Arity, Compare>::contains(Key index) const {
+    return index >= 0 && (std::size_t) index < position.size() && position[index] != kNotQueued;
+}
+
+// grows the position map so index can be queued
+template <typename Key, typename Value, int Arity, typename Compare>
+void HeapPQueuePR<Key, Value, Arity, Compare>::ensureCapacity(Key index) {
+    if ((std::size_t) index >= position.size()) {
+        position.resize(std::max<std::size_t>(index + 1, position.size() * 2), kNotQueued);
+    }
+}
+
+// writes elem into slot and records where it went
+template <typename Key, typename Value, int Arity, typename Compare>
+void HeapPQueuePR<Key, Value, Arity, Compare>::place(int slot, const entry& elem) {
+    heap[slot] = elem;
+    position[elem.index] = slot;
+}
+
+// moves the element at slot toward the root; shifts parents down instead of swapping
+template <typename Key, typename Value, int Arity, typename Compare>
+void HeapPQueuePR<Key, Value, Arity, Compare>::bubbleUp(int slot) {
+    entry elem = heap[slot];
+    while (slot > 0) {
+        int parent = (slot - 1) / Arity;
+        if (!before(elem.val, heap[parent].val)) break;
+        place(slot, heap[parent]);
+        slot = parent;
+    }
+    place(slot, elem);
+}
+
+// trickles down the value at slot, picking the best of up to Arity children
+template <typename Key, typename Value, int Arity, typename Compare>
+void HeapPQueuePR<Key, Value, Arity, Compare>::heapify(int slot) {
+    entry elem = heap[slot];
+    int logSize = heap.size();
+    while (true) {
+        int first = slot * Arity + 1;
+        if (first >= logSize) break;
+        int last = std::min(first + Arity, logSize);
+        int best = first;
+        for (int child = first + 1; child < last; child++) {
+            if (before(heap[child].val, heap[best].val)) best = child;
+        }
+        if (!before(heap[best].val, elem.val)) break;
+        place(slot, heap[best]);
+        slot = best;
+    }
+    place(slot, elem);
+}
+
+// bottom-up construction: heapifies every internal slot from the last one back to the root
+template <typename Key, typename Value, int Arity, typename Compare>
+void HeapPQueuePR<Key, Value, Arity, Compare>::heapifyAll() {
+    if (heap.size() < 2) return;
+    for (int slot = ((int) heap.size() - 2) / Arity; slot >= 0; slot--) heapify(slot);
+}
+
+// adds an element and bubbles it up; a key that is already queued is updated instead
+template <typename Key, typename Value, int Arity, typename Compare>
+void HeapPQueuePR<Key, Value, Arity, Compare>::enqueue(const entry& item) {
+    enqueueOrUpdate(item.index, item.val);
+}
+
+template <typename Key, typename Value, int Arity, typename Compare>
+void HeapPQueuePR<Key, Value, Arity, Compare>::enqueueOrUpdate(Key index, const Value& val) {
+    if (contains(index)) {
+        if (before(val, valueOf(index))) {
+            decreaseKey(index, val);
+        } else {
+            increaseKey(index, val);
+        }
+        return;
+    }
+    ensureCapacity(index);
+    heap.push_back(entry({index, val}));
+    position[index] = heap.size() - 1;
+    bubbleUp(heap.size() - 1);
+}
+
+// val must come out no later than the current value of index
+template <typename Key, typename Value, int Arity, typename Compare>
+void HeapPQueuePR<Key, Value, Arity, Compare>::decreaseKey(Key index, const Value& val) {
+    int slot = position[index];
+    heap[slot].val = val;
+    bubbleUp(slot);
+}
+
+// val must come out no earlier than the current value of index
+template <typename Key, typename Value, int Arity, typename Compare>
+void HeapPQueuePR<Key, Value, Arity, Compare>::increaseKey(Key index, const Value& val) {
+    int slot = position[index];
+    heap[slot].val = val;
+    heapify(slot);
+}
+
+// switches the root and the end, then heapifies to return the min value
+template <typename Key, typename Value, int Arity, typename Compare>
+PQEntry<Key, Value> HeapPQueuePR<Key, Value, Arity, Compare>::extractMin() {
+    entry temp = heap[0];
+    remove(temp.index);
+    return temp;
+}
+
+// fills the hole left by index with the last element and restores the heap around it
+template <typename Key, typename Value, int Arity, typename Compare>
+void HeapPQueuePR<Key, Value, Arity, Compare>::remove(Key index) {
+    int slot = position[index];
+    position[index] = kNotQueued;
+    entry last = heap.back();
+    heap.pop_back();
+    if (slot == (int) heap.size()) return;
+    place(slot, last);
+    if (slot > 0 && before(last.val, heap[(slot - 1) / Arity].val)) {
+        bubbleUp(slot);
+    } else {
+        heapify(slot);
+    }
+}
+
+template <typename Key, typename Value, int Arity, typename Compare>
+void HeapPQueuePR<Key, Value, Arity, Compare>::clear() {
+    for (const entry& elem : heap) position[elem.index] = kNotQueued;
+    heap.clear();
+}
+
+template <typename Key, typename Value, int Arity, typename Compare>
+void HeapPQueuePR<Key, Value, Arity, Compare>::build(const Value *vals, Key n) {
+    clear();
+    ensureCapacity(n > 0 ? n - 1 : 0);
+    heap.resize(n);
+    for (Key i = 0; i < n; i++) place(i, entry({i, vals[i]}));
+    heapifyAll();
+}
 
+// copies the elements of two into one and rebuilds one's heap in linear time;
+// a key queued in both keeps whichever value comes out first
+template <typename Key, typename Value, int Arity, typename Compare>
+HeapPQueuePR<Key, Value, Arity, Compare> *
+HeapPQueuePR<Key, Value, Arity, Compare>::merge(HeapPQueuePR *one, HeapPQueuePR *two) {
+    for (const entry& elem : two->heap) {
+        if (one->contains(elem.index)) {
+            entry& mine = one->heap[one->position[elem.index]];
+            if (one->before(elem.val, mine.val)) mine.val = elem.val;
+        } else {
+            one->ensureCapacity(elem.index);
+            one->position[elem.index] = one->heap.size();
+            one->heap.push_back(elem);
+        }
+    }
+    one->heapifyAll();
+    return one;
+}
@@ -0,0 +1,97 @@
+#include "rank-checkpoint.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+using namespace std;
+
+// identifies a checkpoint file, and its layout version
+static const char kMagic[8] = {'P', 'P', 'R', 'C', 'K', 'P', 'T', '2'};
+
+bool saveRankCheckpoint(const RankCheckpoint& checkpoint, const string& fileName) {
+    string temporary = fileName + ".tmp";
+    {
+        ofstream stream(temporary.c_str(), ios::binary);
+        int32_t n = checkpoint.ranks.size();
+        int64_t m = checkpoint.numEdges;
+        uint64_t hash = checkpoint.graphHash;
+        int32_t iteration = checkpoint.iteration;
+        stream.write(kMagic, sizeof(kMagic));
+        stream.write((const char *) &n, sizeof(n));
+        stream.write((const char *) &m, sizeof(m));
+        stream.write((const char *) &hash, sizeof(hash));
+        stream.write((const char *) &checkpoint.bias, sizeof(double));
+        stream.write((const char *) &iteration, sizeof(iteration));
+        stream.write((const char *) &checkpoint.residual, sizeof(double));
+        stream.write((const char *) checkpoint.ranks.data(), n * sizeof(double));
+        if (!stream.flush()) return false;
+    }
+#ifdef _WIN32
+    // rename will not replace an existing file here
+    remove(fileName.c_str());
+#endif
+    return rename(temporary.c_str(), fileName.c_str()) == 0;
+}
+
+bool loadRankCheckpoint(const string& fileName, RankCheckpoint& checkpoint) {
+    ifstream stream(fileName.c_str(), ios::binary);
+    char magic[sizeof(kMagic)];
+    int32_t n, iteration;
+    int64_t m;
+    uint64_t hash;
+    double bias, residual;
+    stream.read(magic, sizeof(magic));
+    stream.read((char *) &n, sizeof(n));
+    stream.read((char *) &m, sizeof(m));
+    stream.read((char *) &hash, sizeof(hash));
+    stream.read((char *) &bias, sizeof(bias));
+    stream.read((char *) &iteration, sizeof(iteration));
+    stream.read((char *) &residual, sizeof(residual));
+    if (!stream || memcmp(magic, kMagic, sizeof(kMagic)) != 0 || n < 0) return false;
+    vector<double> ranks(n);
+    if (!stream.read((char *) ranks.data(), n * sizeof(double))) return false;
+
+    checkpoint.ranks.swap(ranks);
+    checkpoint.numEdges = m;
+    checkpoint.graphHash = hash;
+    checkpoint.bias = bias;
+    checkpoint.iteration = iteration;
+    checkpoint.residual = residual;
+    return true;
+}
+
+CheckpointWriter::CheckpointWriter(const string& fileName)
+    : fileName(fileName), hasPending(false), finished(false) {
+    worker = thread([this]() {
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            wake.wait(guard, [this]() { return hasPending || finished; });
+            if (!hasPending) return;
+            RankCheckpoint checkpoint;
+            swap(checkpoint, pending);
+            hasPending = false;
+            // the iteration can hand over the next one while this one is written
+            guard.unlock();
+            saveRankCheckpoint(checkpoint, this->fileName);
+            guard.lock();
+        }
+    });
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        lock_guard<mutex> guard(lock);
+        finished = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void CheckpointWriter::submit(const RankCheckpoint& checkpoint) {
+    {
+        lock_guard<mutex> guard(lock);
+        pending = checkpoint;
+        hasPending = true;
+    }
+    wake.notify_one();
+}
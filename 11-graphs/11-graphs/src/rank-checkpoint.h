@@ -0,0 +1,77 @@
+/**
+ * File: rank-checkpoint.h
+ * -----------------------
+ * Exports a compact binary checkpoint of a power iteration in progress
+ * (the rank vector, how many sweeps produced it and the last residual),
+ * so a long solve that crashes or is preempted can pick up where it left
+ * off, and a finished one can warm start related runs.
+ */
+
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Type: RankCheckpoint
+ * --------------------
+ * numEdges, graphHash (a fingerprint of every link and cost) and bias record
+ * what the ranks were computed for, so a resume can tell whether the
+ * iteration carries on or only makes a good guess.
+ */
+struct RankCheckpoint {
+    std::vector<double> ranks;
+    long long numEdges = 0;
+    unsigned long long graphHash = 0;
+    double bias = 0;
+    int iteration = 0;
+    double residual = 0;
+};
+
+/**
+ * Function: saveRankCheckpoint
+ * ----------------------------
+ * Writes checkpoint to a temporary file beside fileName and renames it into
+ * place, so a crash mid-write leaves the previous checkpoint intact.
+ * Returns false if it could not be written; a long solve is better off
+ * carrying on without its checkpoint than stopping.
+ */
+bool saveRankCheckpoint(const RankCheckpoint& checkpoint, const std::string& fileName);
+
+/**
+ * Function: loadRankCheckpoint
+ * ----------------------------
+ * Reads fileName into checkpoint and returns true, or returns false if the
+ * file is missing, truncated or not a checkpoint.
+ */
+bool loadRankCheckpoint(const std::string& fileName, RankCheckpoint& checkpoint);
+
+/**
+ * Class: CheckpointWriter
+ * -----------------------
+ * Saves checkpoints on a background thread so the iteration never waits
+ * on the disk.  Only the newest checkpoint matters: one submitted while an
+ * earlier one is still waiting replaces it.  The destructor writes out
+ * whatever is pending before returning.
+ */
+class CheckpointWriter {
+public:
+    CheckpointWriter(const std::string& fileName);
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void submit(const RankCheckpoint& checkpoint);
+
+private:
+    std::string fileName;
+    std::mutex lock;
+    std::condition_variable wake;
+    RankCheckpoint pending;
+    bool hasPending;
+    bool finished;
+    std::thread worker;
+};
@@ -0,0 +1,425 @@
+#include "rank-engine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RANK_ENGINE_SSE2 1
+#endif
+#include "engine-error.h"
+#include "instrumentation.h"
+#include "parallel.h"
+#include "rank-checkpoint.h"
+using namespace std;
+
+// chunk size for splitting vertex loops across threads
+static const int kGrain = 2048;
+
+RankEngine::RankEngine(const CompactGraph& g, bool weighted)
+    : incoming(transposeGraph(g)), weighted(weighted) {
+    int n = g.numVertices();
+    invOutDegree.assign(n, 0);
+    for (int v = 0; v < n; v++) {
+        double outWeight = 0;
+        for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            outWeight += weighted ? g.costs[e] : 1;
+        }
+        if (outWeight <= 0) {
+            dangling.push_back(v);
+        } else {
+            invOutDegree[v] = 1.0 / outWeight;
+        }
+    }
+    if (weighted) {
+        for (int v = 0; v < n; v++) {
+            for (size_t e = incoming.offsets[v]; e < incoming.offsets[v + 1]; e++) {
+                incoming.costs[e] *= invOutDegree[incoming.targets[e]];
+            }
+        }
+    }
+}
+
+// the rank flowing into v along its in-links
+inline double RankEngine::pull(int v, const vector<double>& ranks) const {
+    double sum = 0;
+    if (weighted) {
+        for (size_t e = incoming.offsets[v]; e < incoming.offsets[v + 1]; e++) {
+            sum += ranks[incoming.targets[e]] * incoming.costs[e];
+        }
+    } else {
+        for (size_t e = incoming.offsets[v]; e < incoming.offsets[v + 1]; e++) {
+            sum += ranks[incoming.targets[e]];
+        }
+    }
+    return sum;
+}
+
+// one power-iteration step from current into next; returns the L1 change
+double RankEngine::iterate(const vector<double>& current, vector<double>& next,
+                           const RankOptions& options) const {
+    INSTRUMENT_SCOPE("rank iteration");
+    int n = numVertices();
+    int numThreads = resolveThreadCount(options.numThreads);
+    double follow = 1 - options.bias;
+    double danglingMass = 0;
+    for (int v : dangling) danglingMass += current[v];
+    double base = (follow * danglingMass + options.bias) / n;
+
+    // share[u] is what u hands to each of its out-links this round (or, when
+    // weighted, what it hands out before the per-link probability)
+    vector<double> share(n);
+    for (int u = 0; u < n; u++) share[u] = weighted ? current[u] : current[u] * invOutDegree[u];
+    vector<double> partial(numThreads, 0);
+    parallelFor(0, n, kGrain, [&](int t, int lo, int hi) {
+        double change = 0;
+        for (int v = lo; v < hi; v++) {
+            next[v] = base + follow * pull(v, share);
+            change += fabs(next[v] - current[v]);
+        }
+        partial[t] += change;
+    }, numThreads);
+
+    double residual = 0;
+    for (double change : partial) residual += change;
+    INSTRUMENT_COUNT("edges traversed", incoming.numEdges());
+    INSTRUMENT_SAMPLE("edges traversed", incoming.numEdges());
+    INSTRUMENT_SAMPLE("residual", residual);
+    return residual;
+}
+
+// folds one word into a running hash, a multiply and a shift per word
+static inline void hashWord(unsigned long long& hash, unsigned long long word) {
+    hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 29;
+}
+
+unsigned long long RankEngine::graphHash() const {
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    hashWord(hash, weighted);
+    for (size_t offset : incoming.offsets) hashWord(hash, offset);
+    for (int target : incoming.targets) hashWord(hash, (unsigned int) target);
+    for (double cost : incoming.costs) {
+        unsigned long long bits;
+        memcpy(&bits, &cost, sizeof(bits));
+        hashWord(hash, bits);
+    }
+    return hash;
+}
+
+RankResult RankEngine::solve(const RankOptions& options) const {
+    int n = numVertices();
+    RankResult start;
+    start.iterations = 0;
+    start.residual = 0;
+    RankCheckpoint checkpoint;
+    if (!options.checkpointFile.empty() && loadRankCheckpoint(options.checkpointFile, checkpoint)
+            && (int) checkpoint.ranks.size() == n) {
+        start.ranks.swap(checkpoint.ranks);
+        // a different graph of the same size only gets a head start
+        if (checkpoint.bias == options.bias && checkpoint.numEdges == (long long) incoming.numEdges()
+                && checkpoint.graphHash == graphHash()) {
+            start.iterations = checkpoint.iteration;
+            start.residual = checkpoint.residual;
+            // it had already converged when it was saved
+            if (start.iterations > 0 && start.residual < options.tolerance) return start;
+        }
+    } else {
+        start.ranks.assign(n, 1.0 / max(1, n));
+    }
+    return iterateFrom(start, options);
+}
+
+RankResult RankEngine::solve(const RankOptions& options, const vector<double>& initial) const {
+    RankResult start;
+    start.ranks = initial;
+    start.iterations = 0;
+    start.residual = 0;
+    return iterateFrom(start, options);
+}
+
+RankResult RankEngine::iterateFrom(RankResult result, const RankOptions& options) const {
+    int n = numVertices();
+    unique_ptr<CheckpointWriter> writer;
+    RankCheckpoint checkpoint;
+    if (!options.checkpointFile.empty()) {
+        writer.reset(new CheckpointWriter(options.checkpointFile));
+        checkpoint.numEdges = incoming.numEdges();
+        checkpoint.graphHash = graphHash();
+        checkpoint.bias = options.bias;
+    }
+
+    vector<double> next(n);
+    for (int it = result.iterations; it < options.maxIterations; it++) {
+        result.residual = iterate(result.ranks, next, options);
+        result.ranks.swap(next);
+        result.iterations = it + 1;
+        if (result.residual < options.tolerance) break;
+        if (writer && result.iterations % max(1, options.checkpointInterval) == 0) {
+            checkpoint.ranks = result.ranks;
+            checkpoint.iteration = result.iterations;
+            checkpoint.residual = result.residual;
+            writer->submit(checkpoint);
+        }
+    }
+    if (writer) {
+        // the final vector is the warm start for whatever runs next
+        checkpoint.ranks = result.ranks;
+        checkpoint.iteration = result.iterations;
+        checkpoint.residual = result.residual;
+        writer->submit(checkpoint);
+    }
+    return result;
+}
+
+vector<RankResult> RankEngine::solveDampingSweep(const vector<double>& biases, const RankOptions& options) const {
+    int n = numVertices();
+    int numThreads = resolveThreadCount(options.numThreads);
+    int count = biases.size();
+    vector<RankResult> results(count);
+    for (double bias : biases) {
+        if (bias <= 0 || bias > 1) error("RankEngine::solveDampingSweep: bias must be in (0, 1]");
+    }
+
+    // with no teleporting, iterate advances x_k to x_(k+1) and returns |x_(k+1) - x_k|
+    RankOptions walk = options;
+    walk.bias = 0;
+    vector<double> current(n, 1.0 / max(1, n)), next(n);
+    vector<double> weight(count, 1); // (1 - bias)^k for the current k
+    vector<int> running;
+    for (int j = 0; j < count; j++) {
+        results[j].ranks.assign(n, 0);
+        results[j].iterations = 0;
+        results[j].residual = 0;
+        running.push_back(j);
+    }
+
+    // the rest of the series, as if x_K were already stationary
+    auto finish = [&](int j) {
+        vector<double>& sum = results[j].ranks;
+        for (int v = 0; v < n; v++) sum[v] += weight[j] * current[v];
+    };
+
+    for (int it = 0; it < options.maxIterations && !running.empty(); it++) {
+        // fold term k into each running sum, then step to x_(k+1)
+        parallelFor(0, n, kGrain, [&](int, int lo, int hi) {
+            for (int j : running) {
+                double scale = biases[j] * weight[j];
+                vector<double>& sum = results[j].ranks;
+                for (int v = lo; v < hi; v++) sum[v] += scale * current[v];
+            }
+        }, numThreads);
+        double change = iterate(current, next, walk);
+        current.swap(next);
+
+        vector<int> stillRunning;
+        for (int j : running) {
+            weight[j] *= 1 - biases[j];
+            results[j].iterations = it + 1;
+            results[j].residual = weight[j] * change;
+            if (results[j].residual < options.tolerance) {
+                finish(j);
+            } else {
+                stillRunning.push_back(j);
+            }
+        }
+        running.swap(stillRunning);
+    }
+    for (int j : running) finish(j);
+    return results;
+}
+
+// Works with the unnormalized system y = (1 - bias) * P^T * y + 1/n, where P
+// has zero rows for dangling pages.  Its solution, scaled to sum to 1, is
+// exactly the PageRank vector with dangling mass spread uniformly, and the
+// system is block triangular over the components, so each component can be
+// solved once its upstream components are known.
+RankResult RankEngine::solveByComponents(const StrongComponents& scc, const RankOptions& options) const {
+    int n = numVertices();
+    int numThreads = resolveThreadCount(options.numThreads);
+    double follow = 1 - options.bias;
+    RankResult result;
+    result.ranks.assign(n, 0);
+    result.iterations = 0;
+    result.residual = 0;
+    if (n == 0) return result;
+
+    // bucket the vertices by component
+    vector<int> start(scc.numComponents + 1, 0);
+    for (int v = 0; v < n; v++) start[scc.component[v] + 1]++;
+    for (int c = 0; c < scc.numComponents; c++) start[c + 1] += start[c];
+    vector<int> members(n);
+    vector<int> cursor(start.begin(), start.end() - 1);
+    for (int v = 0; v < n; v++) members[cursor[scc.component[v]]++] = v;
+
+    // share[u] is u's current value scaled for its out-links, as in iterate
+    vector<double>& y = result.ranks;
+    vector<double> next(n), share(n, 0);
+    for (int c = scc.numComponents - 1; c >= 0; c--) {
+        int lo = start[c], hi = start[c + 1];
+        double componentTolerance = options.tolerance * (hi - lo) / n;
+        for (int it = 0; it < options.maxIterations; it++) {
+            auto sweep = [&](int, int from, int to) {
+                for (int i = from; i < to; i++) {
+                    int v = members[i];
+                    next[v] = 1.0 / n + follow * pull(v, share);
+                }
+            };
+            if (hi - lo >= kGrain) {
+                parallelFor(lo, hi, kGrain, sweep, numThreads);
+            } else {
+                sweep(0, lo, hi);
+            }
+            double change = 0;
+            for (int i = lo; i < hi; i++) {
+                int v = members[i];
+                change += fabs(next[v] - y[v]);
+                y[v] = next[v];
+                share[v] = weighted ? y[v] : y[v] * invOutDegree[v];
+            }
+            result.iterations = max(result.iterations, it + 1);
+            if (change < componentTolerance) break;
+        }
+    }
+
+    double total = 0;
+    for (double value : y) total += value;
+    for (double& value : y) value /= total;
+    // report how far the normalized result is from a fixed point of the full iteration
+    result.residual = iterate(y, next, options);
+    return result;
+}
+
+// adds src[0 .. width-1] (times scale, if given) into acc, two columns per
+// instruction where SSE2 is available; width must be even
+static inline void addRow(double *acc, const double *src, int width) {
+#ifdef RANK_ENGINE_SSE2
+    for (int c = 0; c < width; c += 2) {
+        _mm_storeu_pd(acc + c, _mm_add_pd(_mm_loadu_pd(acc + c), _mm_loadu_pd(src + c)));
+    }
+#else
+    for (int c = 0; c < width; c++) acc[c] += src[c];
+#endif
+}
+
+static inline void addRow(double *acc, const double *src, double scale, int width) {
+#ifdef RANK_ENGINE_SSE2
+    __m128d factor = _mm_set1_pd(scale);
+    for (int c = 0; c < width; c += 2) {
+        _mm_storeu_pd(acc + c, _mm_add_pd(_mm_loadu_pd(acc + c), _mm_mul_pd(_mm_loadu_pd(src + c), factor)));
+    }
+#else
+    for (int c = 0; c < width; c++) acc[c] += scale * src[c];
+#endif
+}
+
+vector<RankResult> RankEngine::solvePersonalized(const vector<vector<int>>& seedSets,
+                                                 const RankOptions& options) const {
+    int n = numVertices();
+    int numThreads = resolveThreadCount(options.numThreads);
+    double follow = 1 - options.bias;
+    vector<RankResult> results(seedSets.size());
+
+    // column c of the block for vertex v lives at v * stride + c; stride is
+    // the number of running columns rounded up to even, and the padding stays 0.
+    // active[c] is the seed set that column c is solving.
+    vector<int> active;
+    int stride = (seedSets.size() + 1) & ~1;
+    vector<double> x(n * stride, 0), teleport(n * stride, 0);
+    for (int j = 0; j < (int) seedSets.size(); j++) {
+        if (seedSets[j].empty()) error("RankEngine::solvePersonalized: empty seed set");
+        for (int s : seedSets[j]) {
+            if (s < 0 || s >= n) error("RankEngine::solvePersonalized: seed out of range");
+            teleport[s * stride + j] += 1.0 / seedSets[j].size();
+        }
+        results[j].iterations = 0;
+        results[j].residual = 0;
+        active.push_back(j);
+    }
+    x = teleport;
+
+    // copies the columns in keep into a narrower block
+    auto narrow = [&](const vector<int>& keep) {
+        int narrowed = (keep.size() + 1) & ~1;
+        vector<double> nx(n * narrowed, 0), nt(n * narrowed, 0);
+        for (int v = 0; v < n; v++) {
+            for (int i = 0; i < (int) keep.size(); i++) {
+                nx[v * narrowed + i] = x[v * stride + keep[i]];
+                nt[v * narrowed + i] = teleport[v * stride + keep[i]];
+            }
+        }
+        x.swap(nx);
+        teleport.swap(nt);
+        stride = narrowed;
+        vector<int> stillActive;
+        for (int c : keep) stillActive.push_back(active[c]);
+        active.swap(stillActive);
+    };
+    auto retire = [&](int c) {
+        RankResult& result = results[active[c]];
+        result.ranks.resize(n);
+        for (int v = 0; v < n; v++) result.ranks[v] = x[v * stride + c];
+    };
+
+    vector<double> next, share;
+    for (int it = 0; it < options.maxIterations && !active.empty(); it++) {
+        INSTRUMENT_SCOPE("personalized rank iteration");
+        int width = active.size();
+        // dangling pages send their surfers back to the seeds along with the teleports
+        vector<double> jump(stride, 0);
+        for (int v : dangling) {
+            for (int c = 0; c < width; c++) jump[c] += x[v * stride + c];
+        }
+        for (int c = 0; c < width; c++) jump[c] = options.bias + follow * jump[c];
+        if (!weighted) {
+            share.resize(n * stride);
+            for (int u = 0; u < n; u++) {
+                for (int c = 0; c < stride; c++) share[u * stride + c] = x[u * stride + c] * invOutDegree[u];
+            }
+        }
+
+        next.resize(n * stride);
+        vector<vector<double>> partial(numThreads, vector<double>(width, 0));
+        parallelFor(0, n, kGrain, [&](int t, int lo, int hi) {
+            vector<double>& change = partial[t];
+            for (int v = lo; v < hi; v++) {
+                double *row = next.data() + v * stride;
+                fill(row, row + stride, 0.0);
+                if (weighted) {
+                    for (size_t e = incoming.offsets[v]; e < incoming.offsets[v + 1]; e++) {
+                        addRow(row, x.data() + incoming.targets[e] * stride, incoming.costs[e], stride);
+                    }
+                } else {
+                    for (size_t e = incoming.offsets[v]; e < incoming.offsets[v + 1]; e++) {
+                        addRow(row, share.data() + incoming.targets[e] * stride, stride);
+                    }
+                }
+                const double *old = x.data() + v * stride;
+                const double *seed = teleport.data() + v * stride;
+                for (int c = 0; c < width; c++) {
+                    row[c] = follow * row[c] + jump[c] * seed[c];
+                    change[c] += fabs(row[c] - old[c]);
+                }
+            }
+        }, numThreads);
+        x.swap(next);
+
+        vector<int> keep;
+        for (int c = 0; c < width; c++) {
+            RankResult& result = results[active[c]];
+            result.iterations = it + 1;
+            result.residual = 0;
+            for (const vector<double>& change : partial) result.residual += change[c];
+            if (result.residual < options.tolerance) {
+                retire(c);
+            } else {
+                keep.push_back(c);
+            }
+        }
+        INSTRUMENT_COUNT("edges traversed", incoming.numEdges());
+        INSTRUMENT_SAMPLE("edges traversed", incoming.numEdges());
+        if ((int) keep.size() < width) narrow(keep);
+    }
+    for (int c = 0; c < (int) active.size(); c++) retire(c);
+    return results;
+}
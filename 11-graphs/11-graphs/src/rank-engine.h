@@ -0,0 +1,143 @@
+/**
+ * File: rank-engine.h
+ * -------------------
+ * Exports a sparse PageRank solver over a CompactGraph.  Instead of
+ * building the dense Markov matrix, each iteration pulls rank along the
+ * in-edges of every page, so an iteration costs O(n + m) rather than
+ * O(n^3) for a matrix product.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include "compact-graph.h"
+#include "strong-components.h"
+
+/**
+ * Type: RankOptions
+ * -----------------
+ * bias has the same meaning as in makeMarkov: the probability of jumping to
+ * a uniformly random page instead of following a link.  Iteration stops
+ * once the L1 change between successive rank vectors drops below tolerance,
+ * or after maxIterations.  numThreads of 0 uses every hardware thread.
+ *
+ * If checkpointFile is set, solve saves its progress there every
+ * checkpointInterval sweeps and once more when it finishes (see
+ * rank-checkpoint.h); the other solvers ignore it.
+ */
+struct RankOptions {
+    double bias = 0.15;
+    double tolerance = 1e-10;
+    int maxIterations = 200;
+    int numThreads = 0;
+    std::string checkpointFile;
+    int checkpointInterval = 10;
+};
+
+/**
+ * Type: RankResult
+ * ----------------
+ * ranks[v] is the PageRank of vertex v (the ranks sum to 1), iterations is
+ * the number of sweeps taken, and residual is the last L1 change.
+ */
+struct RankResult {
+    std::vector<double> ranks;
+    int iterations;
+    double residual;
+};
+
+/**
+ * Class: RankEngine
+ * -----------------
+ * Holds the structure a solve needs (in-edges and inverse out-degrees) so
+ * that it is built once per graph rather than once per solve.  A weighted
+ * engine follows each out-link in proportion to its cost rather than
+ * uniformly, which is how aggregated graphs carry link multiplicities.
+ *
+ * Dangling pages, which would leave all-zero columns in the Markov matrix
+ * and leak rank, are treated as linking to every page.  Rather than adding
+ * those n links apiece, each iteration sums the rank sitting on dangling
+ * pages and spreads it evenly, which is an O(n) correction.
+ */
+class RankEngine {
+public:
+    RankEngine(const CompactGraph& g, bool weighted = false);
+
+    /**
+     * Method: solve
+     * -------------
+     * Runs the power iteration from the uniform vector, or from initial if
+     * one is supplied.  A starting vector close to the answer (a previous
+     * solution, or an estimate like BlockRank's) saves most of the sweeps.
+     *
+     * Without an initial vector, a checkpoint left in checkpointFile for a
+     * graph of this size is picked up instead: if it was saved for exactly
+     * this graph (the same links and costs) and bias, the run
+     * resumes at the checkpoint's iteration (maxIterations counts the
+     * sweeps before it too); otherwise its ranks are only a warm start and
+     * the solve sweeps at least once before trusting the tolerance.
+     */
+    RankResult solve(const RankOptions& options = RankOptions()) const;
+    RankResult solve(const RankOptions& options, const std::vector<double>& initial) const;
+
+    /**
+     * Method: solveByComponents
+     * -------------------------
+     * Computes the same ranks by solving one strongly connected component at
+     * a time, upstream components first.  Rank only flows downstream between
+     * components, so once a component is solved it is final and is never
+     * iterated again; small components usually settle in a pass or two, and
+     * only the giant component pays for many sweeps.
+     */
+    RankResult solveByComponents(const StrongComponents& scc,
+                                 const RankOptions& options = RankOptions()) const;
+
+    /**
+     * Method: solvePersonalized
+     * -------------------------
+     * Solves personalized PageRank for every seed set at once: column j of
+     * the result teleports (and leaves dangling pages) to the pages of
+     * seedSets[j], weighted equally.  The columns are iterated together as
+     * one block of vectors stored row by row, so each sweep reads every
+     * in-edge once for all of them and updates a whole row with SIMD adds.
+     * Each column stops as soon as its own change drops below tolerance and
+     * the block narrows to the columns still running.
+     */
+    std::vector<RankResult> solvePersonalized(const std::vector<std::vector<int>>& seedSets,
+                                              const RankOptions& options = RankOptions()) const;
+
+    /**
+     * Method: solveDampingSweep
+     * -------------------------
+     * Solves for every bias in biases (options.bias is ignored) and returns
+     * the results in the same order.  Power iteration from the uniform
+     * vector produces the same iterates x_k = P^k u whatever the bias, and
+     * after K sweeps its answer is
+     *     bias * sum over k < K of (1 - bias)^k x_k  +  (1 - bias)^K x_K,
+     * so one sequence of sweeps serves the whole list: each bias keeps a
+     * running sum, and stops once its own change, (1 - bias)^K |x_K - x_(K-1)|,
+     * drops below tolerance.  Each result is what solve would return, but
+     * the sweep costs about as many passes over the links as its smallest
+     * bias needs alone.
+     */
+    std::vector<RankResult> solveDampingSweep(const std::vector<double>& biases,
+                                              const RankOptions& options = RankOptions()) const;
+
+    int numVertices() const { return incoming.numVertices(); }
+
+private:
+    CompactGraph incoming;
+    std::vector<double> invOutDegree; // 0 for dangling pages
+    std::vector<int> dangling;
+    bool weighted; // if so, incoming.costs hold transition probabilities
+
+    double pull(int v, const std::vector<double>& ranks) const;
+
+    // a fingerprint of the links, costs and weighting, for checkpoints
+    unsigned long long graphHash() const;
+
+    double iterate(const std::vector<double>& current, std::vector<double>& next,
+                   const RankOptions& options) const;
+
+    RankResult iterateFrom(RankResult start, const RankOptions& options) const;
+};
@@ -0,0 +1,439 @@
+#include "rank-server.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <sstream>
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#include "engine-error.h"
+#include "parallel.h"
+using namespace std;
+
+// idle keep-alive connections are dropped after this many seconds
+static const int kIdleSeconds = 5;
+
+// requests with longer headers (or bodies) than this are refused
+static const size_t kMaxRequestSize = 16384;
+
+// how long the listener is left alone when accepting runs out of descriptors or memory
+static const int kAcceptBackoffMs = 50;
+
+// the poll loop wakes at least this often to drop idle connections
+static const int kPollMs = 1000;
+
+// decodes %XX escapes and '+' in a query string component
+static string urlDecode(const string& text) {
+    string decoded;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '+') {
+            decoded += ' ';
+        } else if (text[i] == '%' && i + 2 < text.size() && isxdigit(text[i + 1]) && isxdigit(text[i + 2])) {
+            decoded += (char) strtol(text.substr(i + 1, 2).c_str(), nullptr, 16);
+            i += 2;
+        } else {
+            decoded += text[i];
+        }
+    }
+    return decoded;
+}
+
+// splits "/path?a=1&b=2" into the path and its parameters
+static string parseTarget(const string& target, map<string, string>& params) {
+    size_t question = target.find('?');
+    string query = question == string::npos ? "" : target.substr(question + 1);
+    stringstream pairs(query);
+    string pair;
+    while (getline(pairs, pair, '&')) {
+        size_t equals = pair.find('=');
+        if (equals == string::npos) continue;
+        params[urlDecode(pair.substr(0, equals))] = urlDecode(pair.substr(equals + 1));
+    }
+    return target.substr(0, question);
+}
+
+// quotes text as a JSON string
+static string jsonString(const string& text) {
+    string quoted = "\"";
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\') {
+            quoted += '\\';
+            quoted += ch;
+        } else if ((unsigned char) ch < 0x20) {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", ch);
+            quoted += escape;
+        } else {
+            quoted += ch;
+        }
+    }
+    return quoted + "\"";
+}
+
+static string jsonNumber(double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.10g", value);
+    return buffer;
+}
+
+// one page as a JSON object
+static string jsonPage(const RankSnapshot& snapshot, int v) {
+    return "{\"title\":" + jsonString(snapshot.graph.names[v]) + ",\"rank\":" + jsonNumber(snapshot.ranks[v])
+           + ",\"position\":" + to_string(snapshot.position[v] + 1) + "}";
+}
+
+static string jsonPages(const RankSnapshot& snapshot, const vector<int>& pages) {
+    string list = "{\"pages\":[";
+    for (size_t i = 0; i < pages.size(); i++) {
+        if (i > 0) list += ",";
+        list += jsonPage(snapshot, pages[i]);
+    }
+    return list + "]}";
+}
+
+static string jsonError(const string& message) {
+    return "{\"error\":" + jsonString(message) + "}";
+}
+
+RankServer::RankServer(const RankStore& store)
+    : store(store), running(false), wakeup(-1) {}
+
+string RankServer::respond(const string& target, int& status) const {
+    map<string, string> params;
+    string path = parseTarget(target, params);
+    int count = params.count("k") ? atoi(params["k"].c_str()) : 10;
+    count = max(0, min(count, kMaxResults));
+    status = 200;
+    if (path == "/status") {
+        string failure = store.refreshFailure();
+        return "{\"version\":" + to_string(store.version()) + ",\"refreshing\":"
+               + (store.isRefreshing() ? "true" : "false") + ",\"refreshFailure\":"
+               + (failure.empty() ? "null" : jsonString(failure)) + "}";
+    }
+    // held for the whole query, so a refresh cannot free it underneath us
+    shared_ptr<const RankSnapshot> snapshot = store.current();
+    if (!snapshot) {
+        status = 503;
+        return jsonError("no ranks have been published yet");
+    }
+    const RankSnapshot& ranked = *snapshot;
+
+    if (path == "/top") {
+        int shown = min(count, ranked.numVertices());
+        return jsonPages(ranked, vector<int>(ranked.byRank.begin(), ranked.byRank.begin() + shown));
+    } else if (path == "/prefix") {
+        return jsonPages(ranked, ranked.topWithPrefix(params["q"], count));
+    } else if (path == "/rank" || path == "/neighbours") {
+        int v = ranked.find(params["title"]);
+        if (v < 0) {
+            status = 404;
+            return jsonError("no page titled " + params["title"]);
+        }
+        if (path == "/rank") return jsonPage(ranked, v);
+        vector<int> pages;
+        for (const std::pair<int, double>& neighbour : ranked.topNeighbours(v, count, params["direction"] == "in")) {
+            pages.push_back(neighbour.first);
+        }
+        return jsonPages(ranked, pages);
+    }
+    status = 404;
+    return jsonError("unknown query " + path);
+}
+
+#ifdef _WIN32
+
+void RankServer::serve(int, int) {
+    error("RankServer::serve: not supported on Windows");
+}
+
+void RankServer::stop() {}
+
+bool RankServer::handleReadable(int, string&) const {
+    return false;
+}
+
+#else
+
+// sends all of text, returning false if the connection went away or
+// stopped reading for kIdleSeconds
+static bool sendAll(int connection, const string& text) {
+    size_t sent = 0;
+    while (sent < text.size()) {
+        ssize_t n = send(connection, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // the socket is non-blocking, so wait here for room in its buffer
+            pollfd writable = {connection, POLLOUT, 0};
+            if (poll(&writable, 1, kIdleSeconds * 1000) <= 0) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool makeNonBlocking(int socketId) {
+    int flags = fcntl(socketId, F_GETFL, 0);
+    return flags >= 0 && fcntl(socketId, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// what the server needs from a request's head
+struct RequestHead {
+    string method, target, version;
+    size_t bodySize = 0;
+    bool close = false;
+};
+
+static string lowercase(string text) {
+    transform(text.begin(), text.end(), text.begin(), ::tolower);
+    return text;
+}
+
+// splits the request line, then reads the header fields on the lines after
+// it; only names at the start of a line count, so a query string that
+// happens to contain "content-length:" is not mistaken for one
+static RequestHead parseHead(const string& head) {
+    RequestHead request;
+    size_t lineEnd = head.find("\r\n");
+    stringstream requestLine(head.substr(0, lineEnd));
+    requestLine >> request.method >> request.target >> request.version;
+    request.close = request.version == "HTTP/1.0";
+    while (lineEnd != string::npos) {
+        size_t start = lineEnd + 2;
+        lineEnd = head.find("\r\n", start);
+        string line = head.substr(start, lineEnd == string::npos ? string::npos : lineEnd - start);
+        size_t colon = line.find(':');
+        if (colon == string::npos) continue;
+        string name = lowercase(line.substr(0, colon));
+        size_t valueStart = line.find_first_not_of(" \t", colon + 1);
+        string value = valueStart == string::npos ? "" : lowercase(line.substr(valueStart));
+        if (name == "content-length") {
+            // anything but digits is refused like an oversized body
+            request.bodySize = !value.empty() && isdigit((unsigned char) value[0])
+                               ? strtoul(value.c_str(), nullptr, 10) : kMaxRequestSize + 1;
+        } else if (name == "connection") {
+            request.close = value.find("close") != string::npos;
+        }
+    }
+    return request;
+}
+
+// reads whatever connection has sent, without waiting for more, and answers
+// every complete request in it; what is left of a partial request stays in
+// pending until the connection is readable again
+bool RankServer::handleReadable(int connection, string& pending) const {
+    char chunk[4096];
+    bool ended = false;
+    // a client sending more than this between answers is refused below
+    while (pending.size() <= 2 * kMaxRequestSize) {
+        ssize_t n = recv(connection, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            pending.append(chunk, n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            // a half-closed client may still be owed answers to what it sent
+            ended = n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+            break;
+        }
+    }
+    while (true) {
+        size_t end = pending.find("\r\n\r\n");
+        if (end == string::npos) return !ended && pending.size() <= kMaxRequestSize;
+        RequestHead request = parseHead(pending.substr(0, end));
+        if (request.bodySize > kMaxRequestSize) return false;
+        // wait for the rest of the body, which is skipped
+        if (pending.size() < end + 4 + request.bodySize) return !ended;
+        pending.erase(0, end + 4 + request.bodySize);
+
+        int status = 405;
+        string body = request.method == "GET" ? respond(request.target, status) : jsonError("only GET is supported");
+        string reason = status == 200 ? "OK" : status == 404 ? "Not Found"
+                       : status == 503 ? "Service Unavailable" : "Method Not Allowed";
+        string response = "HTTP/1.1 " + to_string(status) + " " + reason + "\r\n"
+                          + "Content-Type: application/json\r\n"
+                          + "Content-Length: " + to_string(body.size()) + "\r\n"
+                          + (request.close ? "Connection: close\r\n" : "") + "\r\n" + body;
+        if (!sendAll(connection, response) || request.close) return false;
+    }
+}
+
+// a kept-alive connection, with the start of any request it has only partly sent
+struct ClientConnection {
+    int socket;
+    string pending;
+    chrono::steady_clock::time_point lastActive;
+};
+
+void RankServer::serve(int port, int numThreads) {
+    int socketId = socket(AF_INET, SOCK_STREAM, 0);
+    if (socketId < 0) error("RankServer::serve: cannot create a socket");
+    int on = 1;
+    setsockopt(socketId, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(socketId, (sockaddr *) &address, sizeof(address)) != 0 || listen(socketId, 128) != 0) {
+        ::close(socketId);
+        error("RankServer::serve: cannot listen on port " + to_string(port));
+    }
+    int wakePipe[2];
+    if (!makeNonBlocking(socketId) || pipe(wakePipe) != 0) {
+        ::close(socketId);
+        error("RankServer::serve: cannot set up the listening socket");
+    }
+    makeNonBlocking(wakePipe[0]);
+    makeNonBlocking(wakePipe[1]);
+    wakeup = wakePipe[1];
+    running = true;
+
+    // the poll loop hands readable connections to the workers through ready,
+    // and they hand back the ones kept alive through returned
+    mutex lock;
+    condition_variable work;
+    deque<ClientConnection> ready;
+    vector<ClientConnection> returned;
+    bool finished = false;
+    // the errno of a failure that stopped the server, or 0
+    int failure = 0;
+
+    auto pollLoop = [&]() {
+        vector<ClientConnection> idle;
+        vector<pollfd> watched;
+        auto acceptAgain = chrono::steady_clock::now();
+        while (running) {
+            {
+                lock_guard<mutex> guard(lock);
+                for (ClientConnection& connection : returned) idle.push_back(move(connection));
+                returned.clear();
+            }
+            bool listening = chrono::steady_clock::now() >= acceptAgain;
+            watched.clear();
+            watched.push_back({wakePipe[0], POLLIN, 0});
+            // poll skips a negative descriptor, which rests the listener
+            watched.push_back({listening ? socketId : -1, POLLIN, 0});
+            for (const ClientConnection& connection : idle) watched.push_back({connection.socket, POLLIN, 0});
+            if (poll(watched.data(), watched.size(), listening ? kPollMs : kAcceptBackoffMs) < 0) {
+                if (errno == EINTR) continue;
+                failure = errno;
+                running = false;
+                break;
+            }
+
+            if (watched[0].revents != 0) {
+                char drained[64];
+                while (read(wakePipe[0], drained, sizeof(drained)) > 0) {}
+            }
+            // the connections accepted here are not in watched, so they wait for the next poll
+            size_t polled = idle.size();
+            while (watched[1].revents != 0) {
+                int socket = accept(socketId, nullptr, nullptr);
+                if (socket >= 0) {
+                    int on = 1;
+                    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                    if (makeNonBlocking(socket)) {
+                        idle.push_back({socket, string(), chrono::steady_clock::now()});
+                    } else {
+                        ::close(socket);
+                    }
+                    continue;
+                }
+                int code = errno;
+                if (code == EINTR || code == ECONNABORTED) continue;
+                if (code == EAGAIN || code == EWOULDBLOCK) break;
+                // these pass once other connections close, so leave the listener alone a while
+                if (code == EMFILE || code == ENFILE || code == ENOBUFS || code == ENOMEM) {
+                    acceptAgain = chrono::steady_clock::now() + chrono::milliseconds(kAcceptBackoffMs);
+                    break;
+                }
+                // anything else will not clear up
+                failure = code;
+                running = false;
+                break;
+            }
+
+            auto now = chrono::steady_clock::now();
+            size_t kept = 0;
+            for (size_t i = 0; i < idle.size(); i++) {
+                if (i < polled && watched[i + 2].revents != 0) {
+                    lock_guard<mutex> guard(lock);
+                    ready.push_back(move(idle[i]));
+                    work.notify_one();
+                } else if (now - idle[i].lastActive > chrono::seconds(kIdleSeconds)) {
+                    ::close(idle[i].socket);
+                } else {
+                    if (kept != i) idle[kept] = move(idle[i]);
+                    kept++;
+                }
+            }
+            idle.resize(kept);
+        }
+        for (ClientConnection& connection : idle) ::close(connection.socket);
+        lock_guard<mutex> guard(lock);
+        finished = true;
+        work.notify_all();
+    };
+
+    // thread 0 runs the poll loop; the workers only ever wait for work, never on a client
+    parallelRun(resolveThreadCount(numThreads) + 1, [&](int t) {
+        if (t == 0) {
+            pollLoop();
+            return;
+        }
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            work.wait(guard, [&]() { return finished || !ready.empty(); });
+            if (ready.empty()) return;
+            ClientConnection connection = move(ready.front());
+            ready.pop_front();
+            guard.unlock();
+            bool keep = handleReadable(connection.socket, connection.pending);
+            connection.lastActive = chrono::steady_clock::now();
+            guard.lock();
+            if (!keep || finished) {
+                ::close(connection.socket);
+            } else {
+                returned.push_back(move(connection));
+                // the poll loop is not watching this connection until it wakes
+                ssize_t written = write(wakePipe[1], "x", 1);
+                (void) written;
+            }
+        }
+    });
+    for (ClientConnection& connection : returned) ::close(connection.socket);
+    wakeup = -1;
+    ::close(wakePipe[0]);
+    ::close(wakePipe[1]);
+    ::close(socketId);
+    if (failure != 0) error("RankServer::serve: stopped serving: " + string(strerror(failure)));
+}
+
+void RankServer::stop() {
+    running = false;
+    // wakes the poll loop
+    int pipeEnd = wakeup;
+    if (pipeEnd >= 0) {
+        ssize_t written = write(pipeEnd, "x", 1);
+        (void) written;
+    }
+}
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * File: rank-server.h
+ * -------------------
+ * Exports a small HTTP server that answers rank queries about the
+ * current snapshot in a RankStore on localhost.  The bundled HttpServer in server.h only
+ * declares its interface (its platform hooks are left as TODOs in this
+ * version of the library), so this one sits directly on POSIX sockets.
+ *
+ * Every response is JSON.  The queries are
+ *     /rank?title=T                       rank and position of page T
+ *     /top?k=K                            the K highest ranked pages
+ *     /prefix?q=P&k=K                     the K highest ranked pages whose titles start with P
+ *     /neighbours?title=T&k=K&direction=D the K highest ranked pages T links to (D=out,
+ *                                         the default) or that link to T (D=in)
+ *     /status                             the store's version, whether a refresh is running,
+ *                                         and why the last one failed (null if it did not)
+ * with K defaulting to 10 and capped at kMaxResults.
+ */
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include "rank-store.h"
+
+/**
+ * Constant: kMaxResults
+ * ---------------------
+ * The most pages any one query returns.
+ */
+static const int kMaxResults = 1000;
+
+/**
+ * Class: RankServer
+ * -----------------
+ * Answers queries from whatever snapshot the store holds when each request
+ * arrives, so a refresh can swap in new ranks while the server runs.
+ * Connections are kept alive across requests, so a query costs one hash
+ * lookup or one short scan of a prebuilt index plus the socket round trip.
+ */
+class RankServer {
+public:
+    RankServer(const RankStore& store);
+
+    /**
+     * Method: respond
+     * ---------------
+     * Answers the request target (path and query string) and returns the
+     * JSON body, setting status to the HTTP status code.
+     */
+    std::string respond(const std::string& target, int& status) const;
+
+    /**
+     * Method: serve
+     * -------------
+     * Listens on 127.0.0.1:port and blocks until stop is called from
+     * another thread.  One thread polls the listener and every idle
+     * connection, and hands each connection that has something to read to
+     * one of numThreads workers (hardware threads if 0), which answers the
+     * requests it has sent and hands it back.  Workers never wait on a
+     * quiet client, so idle keep-alive connections cost nothing until
+     * they are dropped after a few seconds.  Running out of descriptors or
+     * memory only pauses accepting for a moment; any other failure to
+     * accept or poll stops the server and is reported through error.
+     */
+    void serve(int port = 8080, int numThreads = 0);
+    void stop();
+
+private:
+    const RankStore& store;
+    std::atomic<bool> running;
+    std::atomic<int> wakeup; // the write end of the pipe that interrupts the poll loop, or -1
+
+    bool handleReadable(int connection, std::string& pending) const;
+};
@@ -0,0 +1,146 @@
+#include "rank-snapshot.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include "engine-error.h"
+using namespace std;
+
+// identifies a snapshot file, and its layout version
+static const char kMagic[8] = {'P', 'P', 'R', 'S', 'N', 'A', 'P', '1'};
+
+int RankSnapshot::find(const string& title) const {
+    auto found = ids.find(title);
+    return found == ids.end() ? -1 : found->second;
+}
+
+vector<int> RankSnapshot::topWithPrefix(const string& prefix, int count) const {
+    auto titleLess = [this](int v, const string& s) { return graph.names[v] < s; };
+    auto first = lower_bound(byName.begin(), byName.end(), prefix, titleLess);
+    vector<int> matches;
+    for (auto it = first; it != byName.end() && graph.names[*it].compare(0, prefix.size(), prefix) == 0; ++it) {
+        matches.push_back(*it);
+    }
+    // position orders by rank, ties included
+    auto higher = [this](int a, int b) { return position[a] < position[b]; };
+    if ((int) matches.size() > count) {
+        partial_sort(matches.begin(), matches.begin() + count, matches.end(), higher);
+        matches.resize(count);
+    } else {
+        sort(matches.begin(), matches.end(), higher);
+    }
+    return matches;
+}
+
+vector<pair<int, double>> RankSnapshot::topNeighbours(int v, int count, bool incomingLinks) const {
+    const CompactGraph& links = incomingLinks ? incoming : graph;
+    vector<int> found(links.targets.begin() + links.offsets[v], links.targets.begin() + links.offsets[v + 1]);
+    sort(found.begin(), found.end());
+    found.erase(unique(found.begin(), found.end()), found.end());
+    auto higher = [this](int a, int b) { return position[a] < position[b]; };
+    if ((int) found.size() > count) {
+        partial_sort(found.begin(), found.begin() + count, found.end(), higher);
+        found.resize(count);
+    } else {
+        sort(found.begin(), found.end(), higher);
+    }
+    vector<pair<int, double>> result;
+    for (int u : found) result.push_back(make_pair(u, ranks[u]));
+    return result;
+}
+
+shared_ptr<const RankSnapshot> makeRankSnapshot(const CompactGraph& g, const vector<double>& ranks) {
+    int n = g.numVertices();
+    if ((int) ranks.size() != n) error("makeRankSnapshot: ranks do not match the graph");
+    shared_ptr<RankSnapshot> snapshot = make_shared<RankSnapshot>();
+    // queries only need the link structure and titles
+    snapshot->graph.offsets = g.offsets;
+    snapshot->graph.targets = g.targets;
+    snapshot->graph.names = g.names;
+    snapshot->graph.costs.assign(g.numEdges(), 1);
+    snapshot->incoming = transposeGraph(snapshot->graph);
+    snapshot->ranks = ranks;
+
+    snapshot->byRank.resize(n);
+    snapshot->byName.resize(n);
+    for (int v = 0; v < n; v++) snapshot->byRank[v] = snapshot->byName[v] = v;
+    stable_sort(snapshot->byRank.begin(), snapshot->byRank.end(),
+                [&ranks](int a, int b) { return ranks[a] > ranks[b]; });
+    snapshot->position.resize(n);
+    for (int i = 0; i < n; i++) snapshot->position[snapshot->byRank[i]] = i;
+    sort(snapshot->byName.begin(), snapshot->byName.end(),
+         [&g](int a, int b) { return g.names[a] < g.names[b]; });
+    snapshot->ids.reserve(n);
+    for (int v = 0; v < n; v++) snapshot->ids[g.names[v]] = v;
+    return snapshot;
+}
+
+// writes the raw bytes of a vector
+template <typename T>
+static void writeArray(ofstream& stream, const vector<T>& values) {
+    stream.write((const char *) values.data(), values.size() * sizeof(T));
+}
+
+template <typename T>
+static bool readArray(ifstream& stream, vector<T>& values, size_t count) {
+    values.resize(count);
+    return (bool) stream.read((char *) values.data(), count * sizeof(T));
+}
+
+void saveRankSnapshot(const RankSnapshot& snapshot, const string& fileName) {
+    ofstream stream(fileName.c_str(), ios::binary);
+    const CompactGraph& g = snapshot.graph;
+    int32_t n = g.numVertices();
+    uint64_t m = g.numEdges();
+    stream.write(kMagic, sizeof(kMagic));
+    stream.write((const char *) &n, sizeof(n));
+    stream.write((const char *) &m, sizeof(m));
+    for (const string& name : g.names) {
+        uint32_t length = name.size();
+        stream.write((const char *) &length, sizeof(length));
+        stream.write(name.data(), length);
+    }
+    vector<uint64_t> offsets(g.offsets.begin(), g.offsets.end());
+    writeArray(stream, offsets);
+    vector<int32_t> targets(g.targets.begin(), g.targets.end());
+    writeArray(stream, targets);
+    writeArray(stream, snapshot.ranks);
+    if (!stream) error("saveRankSnapshot: cannot write " + fileName);
+}
+
+shared_ptr<const RankSnapshot> loadRankSnapshot(const string& fileName) {
+    ifstream stream(fileName.c_str(), ios::binary);
+    if (!stream) error("loadRankSnapshot: cannot open " + fileName);
+    char magic[sizeof(kMagic)];
+    int32_t n;
+    uint64_t m;
+    stream.read(magic, sizeof(magic));
+    stream.read((char *) &n, sizeof(n));
+    stream.read((char *) &m, sizeof(m));
+    if (!stream || memcmp(magic, kMagic, sizeof(kMagic)) != 0 || n < 0) {
+        error("loadRankSnapshot: " + fileName + " is not a rank snapshot");
+    }
+
+    CompactGraph g;
+    g.names.resize(n);
+    for (string& name : g.names) {
+        uint32_t length;
+        if (!stream.read((char *) &length, sizeof(length))) error("loadRankSnapshot: " + fileName + " is truncated");
+        name.resize(length);
+        stream.read(&name[0], length);
+    }
+    vector<uint64_t> offsets;
+    vector<int32_t> targets;
+    vector<double> ranks;
+    if (!readArray(stream, offsets, n + 1) || !readArray(stream, targets, m) || !readArray(stream, ranks, n)) {
+        error("loadRankSnapshot: " + fileName + " is truncated");
+    }
+    g.offsets.assign(offsets.begin(), offsets.end());
+    g.targets.assign(targets.begin(), targets.end());
+    bool consistent = g.offsets[0] == 0 && g.offsets[n] == m;
+    for (int v = 0; v < n && consistent; v++) consistent = g.offsets[v] <= g.offsets[v + 1];
+    for (int t : g.targets) consistent = consistent && t >= 0 && t < n;
+    if (!consistent) error("loadRankSnapshot: " + fileName + " is corrupt");
+    g.costs.assign(m, 1);
+    return makeRankSnapshot(g, ranks);
+}
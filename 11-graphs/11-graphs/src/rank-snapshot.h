@@ -0,0 +1,86 @@
+/**
+ * File: rank-snapshot.h
+ * ---------------------
+ * Exports an immutable bundle of a ranked graph and the indexes needed to
+ * answer queries about it (rank of a title, the top k overall or among the
+ * titles with some prefix, a page's neighbours) without recomputing
+ * anything, plus a compact binary file format so a solve can be done once
+ * and served many times.
+ */
+
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "compact-graph.h"
+
+/**
+ * Type: RankSnapshot
+ * ------------------
+ * graph holds the out-links and incoming the in-links; ranks[v] is the
+ * rank of v.  byRank lists every vertex from highest rank down, position[v]
+ * is where v sits in byRank, byName lists every vertex in title order (so a
+ * prefix is one contiguous run of it), and ids maps a title to its vertex.
+ * Nothing in a snapshot changes after it is made, so any number of threads
+ * may read one at once.
+ */
+struct RankSnapshot {
+    CompactGraph graph;
+    CompactGraph incoming;
+    std::vector<double> ranks;
+    std::vector<int> byRank;
+    std::vector<int> position;
+    std::vector<int> byName;
+    std::unordered_map<std::string, int> ids;
+
+    int numVertices() const { return graph.numVertices(); }
+
+    /**
+     * Method: find
+     * ------------
+     * Returns the vertex titled title, or -1 if there is none.
+     */
+    int find(const std::string& title) const;
+
+    /**
+     * Method: topWithPrefix
+     * ---------------------
+     * Returns up to count vertices whose titles start with prefix, highest
+     * rank first.
+     */
+    std::vector<int> topWithPrefix(const std::string& prefix, int count) const;
+
+    /**
+     * Method: topNeighbours
+     * ---------------------
+     * Returns up to count (vertex, rank) pairs for the pages v links to
+     * (or, if incomingLinks is set, the pages linking to v), highest rank
+     * first.
+     */
+    std::vector<std::pair<int, double>> topNeighbours(int v, int count, bool incomingLinks) const;
+};
+
+/**
+ * Function: makeRankSnapshot
+ * --------------------------
+ * Builds the indexes for g and its ranks and returns the finished snapshot.
+ */
+std::shared_ptr<const RankSnapshot> makeRankSnapshot(const CompactGraph& g, const std::vector<double>& ranks);
+
+/**
+ * Function: saveRankSnapshot
+ * --------------------------
+ * Writes the titles, links and ranks of snapshot to fileName.  The indexes
+ * are rebuilt on load rather than stored.
+ */
+void saveRankSnapshot(const RankSnapshot& snapshot, const std::string& fileName);
+
+/**
+ * Function: loadRankSnapshot
+ * --------------------------
+ * Reads a file written by saveRankSnapshot, signalling an error if it is
+ * missing or malformed.
+ */
+std::shared_ptr<const RankSnapshot> loadRankSnapshot(const std::string& fileName);
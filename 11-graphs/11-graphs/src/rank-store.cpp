@@ -0,0 +1,83 @@
+#include "rank-store.h"
+#include <exception>
+using namespace std;
+
+RankStore::RankStore(shared_ptr<const RankSnapshot> initial)
+    : active(0), publishing(false), refreshing(false), versionCount(initial ? 1 : 0) {
+    slots[0].snapshot = initial;
+    slots[0].readers = 0;
+    slots[1].readers = 0;
+}
+
+RankStore::~RankStore() {
+    waitForRefresh();
+}
+
+shared_ptr<const RankSnapshot> RankStore::current() const {
+    while (true) {
+        int index = active.load();
+        const Slot& slot = slots[index];
+        slot.readers.fetch_add(1);
+        // the slot may have been retired between the load and the announcement
+        if (active.load() == index) {
+            shared_ptr<const RankSnapshot> snapshot = slot.snapshot;
+            slot.readers.fetch_sub(1);
+            return snapshot;
+        }
+        slot.readers.fetch_sub(1);
+    }
+}
+
+void RankStore::publish(shared_ptr<const RankSnapshot> next) {
+    bool idle = false;
+    while (!publishing.compare_exchange_weak(idle, true)) {
+        idle = false;
+        this_thread::yield();
+    }
+    int old = active.load();
+    Slot& spare = slots[1 - old];
+    // a reader that lost the race on this slot is only ever between two atomic ops
+    while (spare.readers.load() != 0) this_thread::yield();
+    spare.snapshot = next;
+    active.store(1 - old);
+    versionCount.fetch_add(1);
+
+    // once the readers copying out of the old slot are gone, only their copies keep it alive
+    Slot& retired = slots[old];
+    while (retired.readers.load() != 0) this_thread::yield();
+    retired.snapshot.reset();
+    publishing.store(false);
+}
+
+bool RankStore::refreshInBackground(function<shared_ptr<const RankSnapshot>()> compute) {
+    bool idle = false;
+    if (!refreshing.compare_exchange_strong(idle, true)) return false;
+    if (worker.joinable()) worker.join();
+    worker = thread([this, compute]() {
+        // an exception escaping the thread would end the process, and the
+        // store would claim to be refreshing forever
+        string problem;
+        try {
+            publish(compute());
+        } catch (const exception& e) {
+            problem = e.what();
+        } catch (...) {
+            problem = "unknown error";
+        }
+        {
+            lock_guard<mutex> guard(failureLock);
+            failure = problem;
+        }
+        refreshing.store(false);
+    });
+    return true;
+}
+
+string RankStore::refreshFailure() const {
+    lock_guard<mutex> guard(failureLock);
+    return failure;
+}
+
+void RankStore::waitForRefresh() {
+    if (worker.joinable()) worker.join();
+}
@@ -0,0 +1,102 @@
+/**
+ * File: rank-store.h
+ * ------------------
+ * Exports the holder for the snapshot a long-running server answers from.
+ * Readers always see one complete, immutable snapshot; a refresh builds
+ * the next one off to the side and swaps it in with a single atomic
+ * store, in the style of read-copy-update, so neither side ever waits on
+ * a lock and query latency does not move while a refresh runs.
+ */
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "rank-snapshot.h"
+
+/**
+ * Class: RankStore
+ * ----------------
+ * The snapshot lives in one of two slots, and an atomic index says which
+ * is current.  A reader announces itself on the current slot, checks the
+ * index has not moved, and copies out the shared_ptr; publishing fills
+ * the other slot once its last reader has left, flips the index, and then
+ * waits for the old slot to drain before letting go of it.  Copies that
+ * readers took keep an old snapshot alive until the last one is dropped,
+ * at which point it is freed.
+ */
+class RankStore {
+public:
+    RankStore(std::shared_ptr<const RankSnapshot> initial = nullptr);
+    ~RankStore();
+
+    RankStore(const RankStore&) = delete;
+    RankStore& operator=(const RankStore&) = delete;
+
+    /**
+     * Method: current
+     * ---------------
+     * Returns the current snapshot (null before the first publish).  This
+     * never blocks: at worst it retries if a publish flips the slots at
+     * the same moment.
+     */
+    std::shared_ptr<const RankSnapshot> current() const;
+
+    /**
+     * Method: publish
+     * ---------------
+     * Makes next the current snapshot.  Publishes are serialized with each
+     * other, and one may wait briefly for readers still copying out of the
+     * slot it reuses, but readers never wait for a publish.
+     */
+    void publish(std::shared_ptr<const RankSnapshot> next);
+
+    /**
+     * Method: refreshInBackground
+     * ---------------------------
+     * Runs compute on a background thread (it may spread its own work over
+     * more threads, as the rank engine does) and publishes what it returns.
+     * If compute throws, the current snapshot stays and the failure is kept
+     * for refreshFailure.  Returns false, and does nothing, if a refresh is
+     * already running.
+     */
+    bool refreshInBackground(std::function<std::shared_ptr<const RankSnapshot>()> compute);
+
+    /**
+     * Method: waitForRefresh
+     * ----------------------
+     * Blocks until any background refresh has been published.
+     */
+    void waitForRefresh();
+
+    bool isRefreshing() const { return refreshing.load(); }
+
+    /**
+     * Method: refreshFailure
+     * ----------------------
+     * Returns why the last background refresh failed, or the empty string
+     * if it succeeded (or none has finished yet).
+     */
+    std::string refreshFailure() const;
+
+    // counts publishes, so clients can tell whether the ranks have moved
+    long version() const { return versionCount.load(); }
+
+private:
+    struct Slot {
+        std::shared_ptr<const RankSnapshot> snapshot;
+        mutable std::atomic<int> readers;
+    };
+
+    Slot slots[2];
+    std::atomic<int> active;
+    std::atomic<bool> publishing;
+    std::atomic<bool> refreshing;
+    std::atomic<long> versionCount;
+    std::thread worker;
+    mutable std::mutex failureLock;
+    std::string failure;
+};
@@ -0,0 +1,98 @@
+/**
+ * File: set-intersection.h
+ * ------------------------
+ * Presents the sorted-set intersection kernel shared by triangle counting
+ * and the neighbour-overlap queries.  On x86 the common case compares four
+ * elements of each list against each other with one SSE2 instruction per
+ * rotation; elsewhere (or near the ends of the lists) it falls back to an
+ * ordinary merge.
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SET_INTERSECTION_SSE2 1
+#endif
+
+/**
+ * Function: intersectSorted
+ * -------------------------
+ * Calls visit(x) for each x in both a[0 .. na-1] and b[0 .. nb-1], in
+ * increasing order, and returns how many there were.  Both lists must be
+ * strictly increasing (sorted, no duplicates).  When one list is much
+ * shorter than the other, each of its elements is found in the longer one
+ * by galloping search instead, which costs O(na log nb) rather than O(na + nb).
+ */
+template <typename Visitor>
+std::size_t intersectSorted(const int *a, std::size_t na, const int *b, std::size_t nb, Visitor visit) {
+    const std::size_t kGallopRatio = 32;
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    std::size_t count = 0;
+    if (na * kGallopRatio < nb) {
+        std::size_t j = 0;
+        for (std::size_t i = 0; i < na && j < nb; i++) {
+            std::size_t step = 1;
+            while (j + step < nb && b[j + step] < a[i]) step *= 2;
+            j = std::lower_bound(b + j, b + std::min(nb, j + step + 1), a[i]) - b;
+            if (j < nb && b[j] == a[i]) {
+                visit(a[i]);
+                count++;
+            }
+        }
+        return count;
+    }
+
+    std::size_t i = 0, j = 0;
+#ifdef SET_INTERSECTION_SSE2
+    // all sixteen pairs of a four-wide block from each list, via three rotations of b
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *) (b + j));
+        __m128i hits = _mm_cmpeq_epi32(va, vb);
+        vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi32(va, vb));
+        vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi32(va, vb));
+        vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi32(va, vb));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(hits));
+        for (int k = 0; k < 4; k++) {
+            if (mask & (1 << k)) {
+                visit(a[i + k]);
+                count++;
+            }
+        }
+        // whichever block ends lower can hold no further matches
+        int lastA = a[i + 3], lastB = b[j + 3];
+        if (lastA <= lastB) i += 4;
+        if (lastB <= lastA) j += 4;
+    }
+#endif
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (b[j] < a[i]) {
+            j++;
+        } else {
+            visit(a[i]);
+            count++;
+            i++;
+            j++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Function: intersectionSize
+ * --------------------------
+ * Returns the number of elements common to two strictly increasing lists.
+ */
+inline std::size_t intersectionSize(const int *a, std::size_t na, const int *b, std::size_t nb) {
+    return intersectSorted(a, na, b, nb, [](int) {});
+}
@@ -0,0 +1,51 @@
+#include "shortest-paths.h"
+#include <algorithm>
+#include <limits>
+#include "pqueue-heap-pagerank.h"
+using namespace std;
+
+ShortestPathTree computeShortestPaths(const CompactGraph& g, int source, int target,
+                                      const ShortestPathObserver *observer) {
+    int n = g.numVertices();
+    ShortestPathTree tree;
+    tree.source = source;
+    tree.dist.assign(n, numeric_limits<double>::infinity());
+    tree.parent.assign(n, -1);
+    tree.parentEdge.assign(n, kNoEdge);
+    bool watchSettled = observer != nullptr && observer->settled;
+    bool watchRelaxed = observer != nullptr && observer->relaxed;
+
+    vector<bool> settled(n, false);
+    HeapPQueuePR<int, double> pq(n);
+    tree.dist[source] = 0;
+    pq.enqueueOrUpdate(source, 0);
+    while (!pq.isEmpty()) {
+        int v = pq.extractMin().index;
+        settled[v] = true;
+        if (watchSettled) observer->settled(tree, v);
+        if (v == target) break;
+        for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            int u = g.targets[e];
+            if (settled[u]) continue;
+            double candidate = tree.dist[v] + g.costs[e];
+            if (candidate < tree.dist[u]) {
+                tree.dist[u] = candidate;
+                tree.parent[u] = v;
+                tree.parentEdge[u] = e;
+                pq.enqueueOrUpdate(u, candidate);
+                if (watchRelaxed) observer->relaxed(tree, e);
+            }
+        }
+    }
+    return tree;
+}
+
+vector<size_t> pathEdgesTo(const ShortestPathTree& tree, int target) {
+    vector<size_t> path;
+    if (tree.parent[target] < 0) return path;
+    for (int v = target; v != tree.source; v = tree.parent[v]) {
+        path.push_back(tree.parentEdge[v]);
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
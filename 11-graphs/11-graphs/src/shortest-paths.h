@@ -0,0 +1,70 @@
+/**
+ * File: shortest-paths.h
+ * ----------------------
+ * Exports Dijkstra's algorithm over a CompactGraph.  Rather than queueing
+ * whole partial paths, the search keeps one distance and one predecessor
+ * edge per vertex and an indexed heap keyed by vertex, so each relaxation
+ * is O(log n) and a path is only materialized once, at the end.
+ */
+
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "compact-graph.h"
+
+/**
+ * Constant: kNoEdge
+ * -----------------
+ * Stored in ShortestPathTree::parentEdge for the source and for vertices
+ * that were never reached.
+ */
+static const std::size_t kNoEdge = (std::size_t) -1;
+
+/**
+ * Type: ShortestPathTree
+ * ----------------------
+ * dist[v] is the cost of the shortest path from source to v (infinity if v
+ * was not reached), parent[v] is the vertex before v on that path (-1 for
+ * the source and unreached vertices), and parentEdge[v] is the index of
+ * the edge from parent[v] to v.  When the search stops early at a target,
+ * only vertices settled before the target are guaranteed to be final.
+ */
+struct ShortestPathTree {
+    int source;
+    std::vector<double> dist;
+    std::vector<int> parent;
+    std::vector<std::size_t> parentEdge;
+};
+
+/**
+ * Type: ShortestPathObserver
+ * --------------------------
+ * Optional hooks for visualizing the search.  settled is called as each
+ * vertex's distance becomes final, and relaxed is called whenever an edge
+ * improves the tentative distance of its endpoint.  Leaving both empty
+ * costs nothing beyond a branch per event.
+ */
+struct ShortestPathObserver {
+    std::function<void(const ShortestPathTree& tree, int vertex)> settled;
+    std::function<void(const ShortestPathTree& tree, std::size_t edge)> relaxed;
+};
+
+/**
+ * Function: computeShortestPaths
+ * ------------------------------
+ * Runs Dijkstra's algorithm from source over the edge costs of g, which must
+ * be non-negative.  If target is a vertex, the search stops as soon as the
+ * target is settled; pass -1 to compute the full shortest-path tree.
+ */
+ShortestPathTree computeShortestPaths(const CompactGraph& g, int source, int target = -1,
+                                      const ShortestPathObserver *observer = nullptr);
+
+/**
+ * Function: pathEdgesTo
+ * ---------------------
+ * Walks parent back from target and returns the edge indices of the
+ * shortest path in source-to-target order, or an empty vector if the target
+ * was not reached.
+ */
+std::vector<std::size_t> pathEdgesTo(const ShortestPathTree& tree, int target);
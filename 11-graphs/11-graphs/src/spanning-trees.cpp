@@ -0,0 +1,130 @@
+#include "spanning-trees.h"
+#include <algorithm>
+#include "disjoint-set.h"
+#include "parallel.h"
+using namespace std;
+
+// an undirected view of one edge; lo/hi order the endpoints so both
+// directions of a bidirectional connection compare equal
+struct CandidateEdge {
+    double cost;
+    int lo, hi;
+    size_t edge;
+};
+
+// total order on candidates: cost first, then endpoints, then edge index
+static bool lighter(const CandidateEdge& a, const CandidateEdge& b) {
+    if (a.cost != b.cost) return a.cost < b.cost;
+    if (a.lo != b.lo) return a.lo < b.lo;
+    if (a.hi != b.hi) return a.hi < b.hi;
+    return a.edge < b.edge;
+}
+
+static CandidateEdge candidateFor(const CompactGraph& g, int from, size_t e) {
+    int to = g.targets[e];
+    CandidateEdge c = {g.costs[e], min(from, to), max(from, to), e};
+    return c;
+}
+
+SpanningForest kruskalForest(const CompactGraph& g, int numThreads,
+                             const function<void(size_t edge)>& edgeAdded) {
+    int n = g.numVertices();
+    vector<CandidateEdge> candidates;
+    candidates.reserve(g.numEdges());
+    for (int v = 0; v < n; v++) {
+        for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            // the second direction of a connection is rejected by the DisjointSet
+            if (g.targets[e] != v) candidates.push_back(candidateFor(g, v, e));
+        }
+    }
+    parallelSort(candidates, lighter, numThreads);
+
+    SpanningForest forest;
+    forest.totalCost = 0;
+    DisjointSet trees(n);
+    for (const CandidateEdge& c : candidates) {
+        if (trees.numSets() == 1) break;
+        if (!trees.unite(c.lo, c.hi)) continue;
+        forest.edges.push_back(c.edge);
+        forest.totalCost += c.cost;
+        if (edgeAdded) edgeAdded(c.edge);
+    }
+    forest.numTrees = trees.numSets();
+    return forest;
+}
+
+SpanningForest boruvkaForest(const CompactGraph& g, int numThreads,
+                             const function<void(size_t edge)>& edgeAdded) {
+    int n = g.numVertices();
+    SpanningForest forest;
+    forest.totalCost = 0;
+    DisjointSet trees(n);
+    vector<int> component(n);
+    for (int v = 0; v < n; v++) component[v] = v;
+
+    // edges are undirected, so each vertex also scans the links into it:
+    // incoming[inOffsets[v] .. inOffsets[v + 1]) are the indices of v's in-edges
+    vector<size_t> inOffsets(n + 1, 0), incoming(g.numEdges());
+    vector<int> sources(g.numEdges());
+    for (int to : g.targets) inOffsets[to + 1]++;
+    for (int v = 0; v < n; v++) inOffsets[v + 1] += inOffsets[v];
+    vector<size_t> next(inOffsets.begin(), inOffsets.end() - 1);
+    for (int u = 0; u < n; u++) {
+        for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+            size_t slot = next[g.targets[e]]++;
+            incoming[slot] = e;
+            sources[slot] = u;
+        }
+    }
+
+    const size_t kNone = (size_t) -1;
+    vector<CandidateEdge> cheapestFromVertex(n);
+    vector<CandidateEdge> cheapestFromTree(n);
+    vector<bool> found(n);
+    while (true) {
+        // every vertex finds its cheapest edge, out or in, leaving its own tree
+        parallelFor(0, n, 1024, [&](int, int lo, int hi) {
+            for (int v = lo; v < hi; v++) {
+                CandidateEdge best = {0, 0, 0, kNone};
+                for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+                    if (component[g.targets[e]] == component[v]) continue;
+                    CandidateEdge c = candidateFor(g, v, e);
+                    if (best.edge == kNone || lighter(c, best)) best = c;
+                }
+                for (size_t i = inOffsets[v]; i < inOffsets[v + 1]; i++) {
+                    if (component[sources[i]] == component[v]) continue;
+                    CandidateEdge c = candidateFor(g, sources[i], incoming[i]);
+                    if (best.edge == kNone || lighter(c, best)) best = c;
+                }
+                cheapestFromVertex[v] = best;
+            }
+        }, numThreads);
+
+        // ...which reduces to the cheapest edge leaving each tree
+        fill(found.begin(), found.end(), false);
+        for (int v = 0; v < n; v++) {
+            const CandidateEdge& c = cheapestFromVertex[v];
+            if (c.edge == kNone) continue;
+            int tree = component[v];
+            if (!found[tree] || lighter(c, cheapestFromTree[tree])) {
+                cheapestFromTree[tree] = c;
+                found[tree] = true;
+            }
+        }
+
+        bool merged = false;
+        for (int tree = 0; tree < n; tree++) {
+            if (!found[tree]) continue;
+            const CandidateEdge& c = cheapestFromTree[tree];
+            if (!trees.unite(c.lo, c.hi)) continue; // both trees picked the same edge
+            forest.edges.push_back(c.edge);
+            forest.totalCost += c.cost;
+            if (edgeAdded) edgeAdded(c.edge);
+            merged = true;
+        }
+        if (!merged) break;
+        for (int v = 0; v < n; v++) component[v] = trees.find(v);
+    }
+    forest.numTrees = trees.numSets();
+    return forest;
+}
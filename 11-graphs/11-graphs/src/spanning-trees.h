@@ -0,0 +1,48 @@
+/**
+ * File: spanning-trees.h
+ * ----------------------
+ * Exports minimum spanning forest algorithms over a CompactGraph.  Edges
+ * are treated as undirected, so a graph built with a forward and backward
+ * arc per connection yields the same forest as one with a single arc.
+ */
+
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "compact-graph.h"
+
+/**
+ * Type: SpanningForest
+ * --------------------
+ * edges holds the indices (into g.targets) of the chosen edges, in the order
+ * they were added; numTrees is the number of trees in the forest, which is 1
+ * exactly when the graph is connected.
+ */
+struct SpanningForest {
+    std::vector<std::size_t> edges;
+    double totalCost;
+    int numTrees;
+};
+
+/**
+ * Function: kruskalForest
+ * -----------------------
+ * Sorts all edges by cost (in parallel) and adds them lightest first,
+ * using a DisjointSet to reject edges that would close a cycle.  If
+ * edgeAdded is supplied, it is called with each edge as it joins the forest.
+ */
+SpanningForest kruskalForest(const CompactGraph& g, int numThreads = 0,
+                             const std::function<void(std::size_t edge)>& edgeAdded = nullptr);
+
+/**
+ * Function: boruvkaForest
+ * -----------------------
+ * Repeatedly has every tree pick the cheapest edge leaving it, following
+ * links in either direction (scanning the vertices in parallel, with an
+ * index of in-edges built up front), and merges along all of them at once,
+ * which takes O(log n) rounds.  Ties are broken by endpoint IDs, so the
+ * result is the same minimum forest for any thread count.
+ */
+SpanningForest boruvkaForest(const CompactGraph& g, int numThreads = 0,
+                             const std::function<void(std::size_t edge)>& edgeAdded = nullptr);
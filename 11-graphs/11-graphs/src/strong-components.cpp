@@ -0,0 +1,109 @@
+#include "strong-components.h"
+#include <algorithm>
+using namespace std;
+
+// one frame of the simulated recursion: a vertex and the next edge to explore
+struct TarjanFrame {
+    int vertex;
+    size_t nextEdge;
+};
+
+StrongComponents findStrongComponents(const CompactGraph& g) {
+    int n = g.numVertices();
+    StrongComponents scc;
+    scc.component.assign(n, -1);
+    scc.numComponents = 0;
+
+    vector<int> discovery(n, -1), low(n, 0);
+    vector<int> open; // vertices visited but not yet assigned a component
+    vector<TarjanFrame> frames;
+    int clock = 0;
+    for (int root = 0; root < n; root++) {
+        if (discovery[root] >= 0) continue;
+        frames.push_back({root, g.offsets[root]});
+        discovery[root] = low[root] = clock++;
+        open.push_back(root);
+        while (!frames.empty()) {
+            TarjanFrame& frame = frames.back();
+            int v = frame.vertex;
+            if (frame.nextEdge < g.offsets[v + 1]) {
+                int u = g.targets[frame.nextEdge++];
+                if (discovery[u] < 0) {
+                    discovery[u] = low[u] = clock++;
+                    open.push_back(u);
+                    frames.push_back({u, g.offsets[u]}); // invalidates frame
+                } else if (scc.component[u] < 0) {
+                    low[v] = min(low[v], discovery[u]);
+                }
+                continue;
+            }
+            // v is finished: close its component if it is a root, then return to the caller
+            if (low[v] == discovery[v]) {
+                int size = 0;
+                int member;
+                do {
+                    member = open.back();
+                    open.pop_back();
+                    scc.component[member] = scc.numComponents;
+                    size++;
+                } while (member != v);
+                scc.sizes.push_back(size);
+                scc.numComponents++;
+            }
+            frames.pop_back();
+            if (!frames.empty()) {
+                int caller = frames.back().vertex;
+                low[caller] = min(low[caller], low[v]);
+            }
+        }
+    }
+    return scc;
+}
+
+GraphAnalysis analyzeGraph(const CompactGraph& g) {
+    GraphAnalysis analysis;
+    analysis.components = findStrongComponents(g);
+    const StrongComponents& scc = analysis.components;
+
+    vector<bool> hasExit(scc.numComponents, false);
+    for (int v = 0; v < g.numVertices(); v++) {
+        if (g.outDegree(v) == 0) analysis.danglingVertices.push_back(v);
+        for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            if (scc.component[g.targets[e]] != scc.component[v]) hasExit[scc.component[v]] = true;
+        }
+    }
+    analysis.largestComponent = -1;
+    for (int c = 0; c < scc.numComponents; c++) {
+        if (!hasExit[c]) analysis.sinkComponents.push_back(c);
+        if (analysis.largestComponent < 0 || scc.sizes[c] > scc.sizes[analysis.largestComponent]) {
+            analysis.largestComponent = c;
+        }
+    }
+    return analysis;
+}
+
+void reportGraphAnalysis(const CompactGraph& g, const GraphAnalysis& analysis,
+                         ostream& out, int maxListed) {
+    const StrongComponents& scc = analysis.components;
+    out << g.numVertices() << " pages, " << g.numEdges() << " links, "
+        << scc.numComponents << " strongly connected components" << endl;
+    if (analysis.largestComponent >= 0) {
+        out << "Largest component: " << scc.sizes[analysis.largestComponent] << " pages" << endl;
+    }
+
+    out << analysis.danglingVertices.size() << " dangling pages (no out-links)" << endl;
+    for (int i = 0; i < (int) analysis.danglingVertices.size() && i < maxListed; i++) {
+        out << "    " << g.names[analysis.danglingVertices[i]] << endl;
+    }
+
+    // a lone dangling page is also a sink component, so only list the larger ones
+    int listed = 0;
+    out << analysis.sinkComponents.size() << " sink components (no links leaving them)" << endl;
+    for (int c : analysis.sinkComponents) {
+        if (scc.sizes[c] < 2 || listed >= maxListed) continue;
+        int example = 0;
+        while (scc.component[example] != c) example++;
+        out << "    component of " << scc.sizes[c] << " pages including " << g.names[example] << endl;
+        listed++;
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * File: strong-components.h
+ * -------------------------
+ * Exports an iterative version of Tarjan's strongly connected components
+ * algorithm and a pass that uses it to find where PageRank mass leaks or
+ * pools: dangling pages (no out-links) and sink components (no links out
+ * of the component).
+ */
+
+#pragma once
+#include <iostream>
+#include <vector>
+#include "compact-graph.h"
+
+/**
+ * Type: StrongComponents
+ * ----------------------
+ * component[v] is the ID of v's component.  IDs are assigned in reverse
+ * topological order of the condensation: every edge between two different
+ * components goes from a higher ID to a lower one, so component 0 is a
+ * sink and counting down from numComponents - 1 visits upstream first.
+ */
+struct StrongComponents {
+    std::vector<int> component;
+    std::vector<int> sizes;
+    int numComponents;
+};
+
+/**
+ * Function: findStrongComponents
+ * ------------------------------
+ * Runs Tarjan's algorithm with an explicit stack, so deep graphs cannot
+ * overflow the call stack.  Linear in the size of the graph.
+ */
+StrongComponents findStrongComponents(const CompactGraph& g);
+
+/**
+ * Type: GraphAnalysis
+ * -------------------
+ * The result of analyzeGraph: the components, the dangling vertices, the
+ * sink components (by ID) and the largest component.
+ */
+struct GraphAnalysis {
+    StrongComponents components;
+    std::vector<int> danglingVertices;
+    std::vector<int> sinkComponents;
+    int largestComponent;
+};
+
+/**
+ * Function: analyzeGraph
+ * ----------------------
+ * Finds the strongly connected components of g along with its dangling
+ * vertices and sink components.
+ */
+GraphAnalysis analyzeGraph(const CompactGraph& g);
+
+/**
+ * Function: reportGraphAnalysis
+ * -----------------------------
+ * Prints a summary of the analysis, listing up to maxListed dangling
+ * pages and sink components by name.
+ */
+void reportGraphAnalysis(const CompactGraph& g, const GraphAnalysis& analysis,
+                         std::ostream& out = std::cout, int maxListed = 20);
@@ -0,0 +1,115 @@
+#include "triangles.h"
+#include <algorithm>
+#include "parallel.h"
+#include "set-intersection.h"
+using namespace std;
+
+// vertices are handed to threads in chunks of this many; hubs make the
+// work per vertex very uneven, so chunks stay small
+static const int kGrain = 64;
+
+// orients each edge of the simple graph g toward its higher (degree, ID) end
+static CompactGraph orientByDegree(const CompactGraph& g) {
+    int n = g.numVertices();
+    auto before = [&g](int u, int v) {
+        return g.outDegree(u) < g.outDegree(v) || (g.outDegree(u) == g.outDegree(v) && u < v);
+    };
+    CompactGraph oriented;
+    oriented.offsets.push_back(0);
+    for (int u = 0; u < n; u++) {
+        // filtering keeps the slice sorted by target
+        for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+            if (before(u, g.targets[e])) oriented.targets.push_back(g.targets[e]);
+        }
+        oriented.offsets.push_back(oriented.targets.size());
+    }
+    return oriented;
+}
+
+TriangleCounts countTriangles(const CompactGraph& g, int numThreads) {
+    CompactGraph simple = undirectedGraph(g);
+    CompactGraph oriented = orientByDegree(simple);
+    int n = simple.numVertices();
+    numThreads = resolveThreadCount(numThreads);
+
+    // each thread tallies into its own array, summed afterwards
+    vector<vector<long long>> tallies(numThreads);
+    parallelFor(0, n, kGrain, [&](int t, int lo, int hi) {
+        vector<long long>& tally = tallies[t];
+        if (tally.empty()) tally.assign(n, 0);
+        for (int u = lo; u < hi; u++) {
+            const int *outU = oriented.targets.data() + oriented.offsets[u];
+            size_t degU = oriented.offsets[u + 1] - oriented.offsets[u];
+            for (size_t i = 0; i < degU; i++) {
+                int v = outU[i];
+                const int *outV = oriented.targets.data() + oriented.offsets[v];
+                size_t degV = oriented.offsets[v + 1] - oriented.offsets[v];
+                size_t found = intersectSorted(outU, degU, outV, degV, [&tally](int w) { tally[w]++; });
+                tally[u] += found;
+                tally[v] += found;
+            }
+        }
+    }, numThreads);
+
+    TriangleCounts counts;
+    counts.perVertex.assign(n, 0);
+    counts.clustering.assign(n, 0);
+    parallelFor(0, n, 4096, [&](int, int lo, int hi) {
+        for (int v = lo; v < hi; v++) {
+            for (const vector<long long>& tally : tallies) {
+                if (!tally.empty()) counts.perVertex[v] += tally[v];
+            }
+            long long degree = simple.outDegree(v);
+            if (degree >= 2) counts.clustering[v] = 2.0 * counts.perVertex[v] / (degree * (degree - 1));
+        }
+    }, numThreads);
+
+    long long corners = 0;
+    double wedges = 0, clusteringSum = 0;
+    for (int v = 0; v < n; v++) {
+        long long degree = simple.outDegree(v);
+        corners += counts.perVertex[v];
+        wedges += degree * (degree - 1) / 2.0;
+        clusteringSum += counts.clustering[v];
+    }
+    counts.total = corners / 3;
+    counts.averageClustering = n > 0 ? clusteringSum / n : 0;
+    counts.transitivity = wedges > 0 ? 3.0 * counts.total / wedges : 0;
+    return counts;
+}
+
+int commonNeighbours(const CompactGraph& g, int u, int v) {
+    return intersectionSize(g.targets.data() + g.offsets[u], g.outDegree(u),
+                            g.targets.data() + g.offsets[v], g.outDegree(v));
+}
+
+double jaccardSimilarity(const CompactGraph& g, int u, int v) {
+    int shared = commonNeighbours(g, u, v);
+    int either = g.outDegree(u) + g.outDegree(v) - shared;
+    return either > 0 ? (double) shared / either : 0;
+}
+
+vector<pair<int, double>> mostSimilar(const CompactGraph& g, int v, int count) {
+    vector<int> candidates;
+    for (size_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+        int u = g.targets[e];
+        for (size_t f = g.offsets[u]; f < g.offsets[u + 1]; f++) {
+            if (g.targets[f] != v) candidates.push_back(g.targets[f]);
+        }
+    }
+    sort(candidates.begin(), candidates.end());
+    candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
+    vector<pair<int, double>> scored;
+    for (int u : candidates) scored.push_back(make_pair(u, jaccardSimilarity(g, v, u)));
+    auto better = [](const pair<int, double>& a, const pair<int, double>& b) {
+        return a.second > b.second || (a.second == b.second && a.first < b.first);
+    };
+    if ((int) scored.size() > count) {
+        partial_sort(scored.begin(), scored.begin() + count, scored.end(), better);
+        scored.resize(count);
+    } else {
+        sort(scored.begin(), scored.end(), better);
+    }
+    return scored;
+}
@@ -0,0 +1,66 @@
+/**
+ * File: triangles.h
+ * -----------------
+ * Exports parallel triangle counting, local clustering coefficients and
+ * neighbour-overlap similarity over a CompactGraph.  A tight cluster of
+ * pages that co-occur with one another far more than with anything else
+ * (a spammy clique) shows up as a run of clustering coefficients near 1.
+ */
+
+#pragma once
+#include <utility>
+#include <vector>
+#include "compact-graph.h"
+
+/**
+ * Type: TriangleCounts
+ * --------------------
+ * perVertex[v] is the number of triangles through v and clustering[v] is
+ * the fraction of pairs of v's neighbours that are themselves linked (0 for
+ * vertices with fewer than two neighbours).  transitivity is the global
+ * fraction, 3 * total over the number of connected triples.
+ */
+struct TriangleCounts {
+    std::vector<long long> perVertex;
+    std::vector<double> clustering;
+    long long total;
+    double averageClustering;
+    double transitivity;
+};
+
+/**
+ * Function: countTriangles
+ * ------------------------
+ * Counts the triangles of the undirected graph underlying g.  Each edge is
+ * oriented from its lower-degree end to its higher-degree end, so every
+ * triangle is found exactly once and no vertex scans more than O(sqrt(m))
+ * out-neighbours; each oriented edge u -> v then contributes the
+ * intersection of the out-lists of u and v.  Vertices are shared among
+ * numThreads threads.
+ */
+TriangleCounts countTriangles(const CompactGraph& g, int numThreads = 0);
+
+/**
+ * Function: commonNeighbours
+ * --------------------------
+ * Returns the number of neighbours u and v share.  g must have strictly
+ * increasing slices, as undirectedGraph produces.
+ */
+int commonNeighbours(const CompactGraph& g, int u, int v);
+
+/**
+ * Function: jaccardSimilarity
+ * ---------------------------
+ * Returns |N(u) & N(v)| / |N(u) | N(v)|, or 0 if both have no neighbours,
+ * with the same requirement on g as commonNeighbours.
+ */
+double jaccardSimilarity(const CompactGraph& g, int u, int v);
+
+/**
+ * Function: mostSimilar
+ * ---------------------
+ * Returns up to count (vertex, Jaccard similarity) pairs for the vertices
+ * most similar to v, best first.  Only vertices within two hops of v can
+ * share a neighbour with it, so only those are scored.
+ */
+std::vector<std::pair<int, double>> mostSimilar(const CompactGraph& g, int v, int count = 10);
@@ -0,0 +1,78 @@
+#include "warm-start.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include "engine-error.h"
+using namespace std;
+
+// parses "12 - Title     0.00081" into its position, title and rank
+static bool parseRankLine(string line, int& position, string& title, double& rank) {
+    if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+    size_t digits = 0;
+    while (digits < line.size() && isdigit((unsigned char) line[digits])) digits++;
+    if (digits == 0 || line.compare(digits, 3, " - ") != 0) return false;
+    size_t gap = line.find_last_of(" \t");
+    if (gap == string::npos || gap < digits + 3) return false;
+
+    const char *value = line.c_str() + gap + 1;
+    char *end;
+    rank = strtod(value, &end);
+    if (end == value || *end != '\0') return false;
+    size_t last = line.find_last_not_of(" \t", gap);
+    if (last == string::npos || last < digits + 3) return false;
+    title = line.substr(digits + 3, last - digits - 2);
+    position = atoi(line.c_str());
+    return true;
+}
+
+unordered_map<string, double> readRankOutput(const string& fileName) {
+    ifstream stream(fileName.c_str());
+    if (!stream) error("readRankOutput: cannot open " + fileName);
+    unordered_map<string, double> ranks;
+    string line, title;
+    int position;
+    double rank;
+    while (getline(stream, line)) {
+        if (!parseRankLine(line, position, title, rank)) continue;
+        // a new listing supersedes the earlier ones
+        if (position == 1) ranks.clear();
+        ranks[title] = rank;
+    }
+    return ranks;
+}
+
+unordered_map<string, double> snapshotRanks(const RankSnapshot& snapshot) {
+    unordered_map<string, double> ranks;
+    ranks.reserve(snapshot.numVertices());
+    for (int v = 0; v < snapshot.numVertices(); v++) ranks[snapshot.graph.names[v]] = snapshot.ranks[v];
+    return ranks;
+}
+
+vector<double> warmStartRanks(const CompactGraph& g, const unordered_map<string, double>& previous, int *matched) {
+    int n = g.numVertices();
+    vector<double> ranks(n, -1);
+    int found = 0;
+    double listedMass = 0, smallest = 1;
+    for (int v = 0; v < n; v++) {
+        auto entry = previous.find(g.names[v]);
+        if (entry == previous.end() || entry->second <= 0) continue;
+        ranks[v] = entry->second;
+        listedMass += entry->second;
+        smallest = min(smallest, entry->second);
+        found++;
+    }
+    if (matched != nullptr) *matched = found;
+    if (n == 0) return ranks;
+    if (found == 0) return vector<double>(n, 1.0 / n);
+
+    double unlisted = smallest;
+    if (found < n && listedMass < 1) unlisted = min(smallest, (1 - listedMass) / (n - found));
+    double total = 0;
+    for (double& rank : ranks) {
+        if (rank < 0) rank = unlisted;
+        total += rank;
+    }
+    for (double& rank : ranks) rank /= total;
+    return ranks;
+}
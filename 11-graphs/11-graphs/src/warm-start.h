@@ -0,0 +1,47 @@
+/**
+ * File: warm-start.h
+ * ------------------
+ * Exports helpers for starting a solve from an earlier run's ranks instead
+ * of the uniform vector.  Page ids change whenever the scrape does, so the
+ * earlier ranks are carried over by title, from a rank snapshot or from a
+ * printed result list like the ones saved in Outputs/.
+ */
+
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "compact-graph.h"
+#include "rank-snapshot.h"
+
+/**
+ * Function: readRankOutput
+ * ------------------------
+ * Reads the ranks listed in a saved console log.  Every line of the form
+ *     12 - Edmund Husserl     0.000813659
+ * (as getRank prints them) contributes a title and its rank; progress
+ * messages and anything else are skipped.  The older logs print the top
+ * of the ranking after every iteration, so only the last listing is
+ * kept.  Only the top was ever printed, so the map is far from complete.
+ */
+std::unordered_map<std::string, double> readRankOutput(const std::string& fileName);
+
+/**
+ * Function: snapshotRanks
+ * -----------------------
+ * Returns every title in snapshot with its rank.
+ */
+std::unordered_map<std::string, double> snapshotRanks(const RankSnapshot& snapshot);
+
+/**
+ * Function: warmStartRanks
+ * ------------------------
+ * Builds a starting vector for g from earlier ranks: a page listed in
+ * previous keeps its old rank, and whatever mass the listed pages leave
+ * over is shared evenly among the rest, though none of them gets more than
+ * the smallest listed rank (the printed logs are not always normalized).
+ * The result sums to 1.  If matched is given, it is set to the number of
+ * pages found in previous.
+ */
+std::vector<double> warmStartRanks(const CompactGraph& g, const std::unordered_map<std::string, double>& previous,
+                                   int *matched = nullptr);
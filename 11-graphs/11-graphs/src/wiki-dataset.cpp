@@ -0,0 +1,132 @@
+#include "wiki-dataset.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <unordered_map>
+#ifdef GRAPHS_ZLIB
+#include <zlib.h>
+#endif
+#include "engine-error.h"
+#include "instrumentation.h"
+using namespace std;
+
+unordered_set<string> loadEntities(const string& fileName) {
+    INSTRUMENT_SCOPE("loadEntities");
+    ifstream stream(fileName.c_str());
+    if (!stream) error("loadEntities: cannot open " + fileName);
+    unordered_set<string> entities;
+    string line;
+    while (getline(stream, line)) {
+        INSTRUMENT_COUNT("lines parsed", 1);
+        entities.insert(line);
+    }
+    return entities;
+}
+
+CompactGraph loadWikipediaGraph(const vector<string>& linkFiles, const unordered_set<string>& entities) {
+    INSTRUMENT_SCOPE("loadWikipediaGraph");
+    vector<string> names(entities.begin(), entities.end());
+    sort(names.begin(), names.end());
+    unordered_map<string, int> ids;
+    ids.reserve(names.size());
+    for (int v = 0; v < (int) names.size(); v++) ids[names[v]] = v;
+
+    vector<WeightedEdge> edges;
+    string title, links, item;
+    for (const string& fileName : linkFiles) {
+        ifstream stream(fileName.c_str());
+        if (!stream) error("loadWikipediaGraph: cannot open " + fileName);
+        while (getline(stream, title) && getline(stream, links)) {
+            INSTRUMENT_COUNT("lines parsed", 2);
+            auto from = ids.find(title);
+            if (from == ids.end()) continue;
+            // titles after the first keep the space that followed their comma
+            size_t start = 0;
+            for (bool first = true; start < links.size(); first = false) {
+                size_t comma = links.find(',', start);
+                if (comma == string::npos) comma = links.size();
+                item.assign(links, start, comma - start);
+                if (!first && item.length() > 1) item.erase(0, 1);
+                auto to = ids.find(item);
+                if (to != ids.end()) edges.push_back({from->second, to->second, 1});
+                start = comma + 1;
+            }
+        }
+    }
+    INSTRUMENT_COUNT("arcs created", edges.size());
+    CompactGraph g = buildCompactGraph(names.size(), edges);
+    g.names.swap(names);
+    return g;
+}
+
+// reads a file line by line, through zlib when it is available (which
+// also reads uncompressed files)
+class LineReader {
+public:
+    LineReader(const string& fileName) {
+#ifdef GRAPHS_ZLIB
+        file = gzopen(fileName.c_str(), "rb");
+#else
+        if (fileName.size() > 3 && fileName.compare(fileName.size() - 3, 3, ".gz") == 0) {
+            error("loadEdgeList: this build cannot read compressed files like " + fileName);
+        }
+        file = fopen(fileName.c_str(), "rb");
+#endif
+        if (file == nullptr) error("loadEdgeList: cannot open " + fileName);
+    }
+
+    ~LineReader() {
+#ifdef GRAPHS_ZLIB
+        gzclose(file);
+#else
+        fclose(file);
+#endif
+    }
+
+    // returns the next line (cut at sizeof(buffer) characters), or nullptr at the end
+    const char *next() {
+#ifdef GRAPHS_ZLIB
+        return gzgets(file, buffer, sizeof(buffer));
+#else
+        return fgets(buffer, sizeof(buffer), file);
+#endif
+    }
+
+private:
+#ifdef GRAPHS_ZLIB
+    gzFile file;
+#else
+    FILE *file;
+#endif
+    char buffer[4096];
+};
+
+CompactGraph loadEdgeList(const string& fileName) {
+    INSTRUMENT_SCOPE("loadEdgeList");
+    LineReader reader(fileName);
+    unordered_map<long long, int> ids;
+    vector<long long> labels;
+    vector<WeightedEdge> edges;
+    auto idOf = [&](long long label) {
+        auto found = ids.emplace(label, (int) labels.size());
+        if (found.second) labels.push_back(label);
+        return found.first->second;
+    };
+    while (const char *line = reader.next()) {
+        INSTRUMENT_COUNT("lines parsed", 1);
+        if (line[0] == '#') continue;
+        char *end;
+        long long from = strtoll(line, &end, 10);
+        if (end == line) continue;
+        const char *rest = end;
+        long long to = strtoll(rest, &end, 10);
+        if (end == rest) continue;
+        int u = idOf(from);
+        edges.push_back({u, idOf(to), 1});
+    }
+    INSTRUMENT_COUNT("arcs created", edges.size());
+    CompactGraph g = buildCompactGraph(labels.size(), edges);
+    for (int v = 0; v < (int) labels.size(); v++) g.names[v] = to_string(labels[v]);
+    return g;
+}
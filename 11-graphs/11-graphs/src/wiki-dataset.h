@@ -0,0 +1,44 @@
+/**
+ * File: wiki-dataset.h
+ * --------------------
+ * Exports readers for the scraped Wikipedia datasets that build a
+ * CompactGraph directly, without the node/arc graph in between, so that
+ * tools that do not link the Stanford library can load them too.
+ */
+
+#pragma once
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "compact-graph.h"
+
+/**
+ * Function: loadEntities
+ * ----------------------
+ * Returns the titles in a names file, one per line (buildEntities in
+ * page-rank.cpp does the same with a HashSet).
+ */
+std::unordered_set<std::string> loadEntities(const std::string& fileName);
+
+/**
+ * Function: loadWikipediaGraph
+ * ----------------------------
+ * Builds the link graph over entities from the given link files, which
+ * alternate a title line with a line of the comma-separated titles that
+ * page links to.  Vertices are numbered in title order, as toCompactGraph
+ * numbers buildWikipediaGraph's nodes, and every listed link to an entity
+ * becomes an edge of cost 1, so the result is the same graph.  Links from
+ * pages that are not entities are skipped.
+ */
+CompactGraph loadWikipediaGraph(const std::vector<std::string>& linkFiles,
+                                const std::unordered_set<std::string>& entities);
+
+/**
+ * Function: loadEdgeList
+ * ----------------------
+ * Builds a graph from a SNAP-style edge list ("from to" per line, with
+ * '#' comment lines), numbering vertices in order of first appearance and
+ * naming each after its id in the file.  The file may be gzip-compressed
+ * if the build has zlib (GRAPHS_ZLIB); otherwise .gz files are refused.
+ */
+CompactGraph loadEdgeList(const std::string& fileName);